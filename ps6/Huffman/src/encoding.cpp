@@ -1,7 +1,39 @@
+#include <climits>
+#include <cstdint>
+#include <vector>
 #include "encoding.h"
+#include "error.h"
 #include "filelib.h"
 #include "pqueue.h"
 
+// Number of bytes read from the input stream at a time
+const int CHUNK_SIZE = 1 << 16;
+
+// Number of histograms that consecutive bytes are counted into in turn
+const int NUM_HISTOGRAMS = 4;
+
+/*
+ * Helper function to buildFrequencyTable which adds the counts of the given
+ * bytes to the histograms. Counting a run of equal bytes into a single table
+ * makes every increment wait for the store of the one before it, so consecutive
+ * bytes go to different histograms instead, and those are summed at the end.
+ */
+void countBytes(const unsigned char* bytes, int numBytes,
+                uint64_t histograms[NUM_HISTOGRAMS][PSEUDO_EOF]) {
+
+    int i = 0;
+    for (; i + NUM_HISTOGRAMS <= numBytes; i += NUM_HISTOGRAMS) {
+        for (int h = 0; h < NUM_HISTOGRAMS; h++) {
+            histograms[h][bytes[i + h]]++;
+        }
+    }
+
+    // Count the bytes left over at the end of the chunk
+    for (; i < numBytes; i++) {
+        histograms[0][bytes[i]]++;
+    }
+}
+
 /*
  * Reads input from a given istream (which could be a file on disk, a string
  * buffer, etc.). It then counts and returns a mapping from each character
@@ -10,34 +42,39 @@
  * PSEUDO_EOF into the map. We assume that the input file exists and can
  * be read, though the file might be empty. An empty file would cause the
  * function to return a map containing only the 1 occurrence of PSEUDO_EOF.
+ * The input is read in large chunks and counted into flat arrays, and the
+ * map is only built once every count is known.
  */
 Map<int, int> buildFrequencyTable(istream& input) {
-    Map<int, int> freqTable;
 
-    // Initialize the currChar from istream
-    int currChar = input.get();
-
-    // Loop over file and get characters one by one
-    while (currChar != -1) {
+    // Count every chunk of the input into the histograms
+    uint64_t histograms[NUM_HISTOGRAMS][PSEUDO_EOF] = {};
+    vector<unsigned char> buffer(CHUNK_SIZE);
+    while (input) {
+        input.read(reinterpret_cast<char*>(buffer.data()), CHUNK_SIZE);
+        countBytes(buffer.data(), input.gcount(), histograms);
+    }
 
-        // if character doesn't already exist in map, initialize as 1
-        if (!freqTable.containsKey(currChar)) {
-            freqTable.put(currChar, 1);
+    // Sum the histograms into one count per character, plus PSEUDO_EOF
+    uint64_t counts[PSEUDO_EOF + 1] = {};
+    for (int currChar = 0; currChar < PSEUDO_EOF; currChar++) {
+        for (int h = 0; h < NUM_HISTOGRAMS; h++) {
+            counts[currChar] += histograms[h][currChar];
         }
+    }
+    counts[PSEUDO_EOF] = 1;
 
-        // else increment value of that key by 1
-        else {
-            int currVal = freqTable[currChar];
-            freqTable.put(currChar, currVal + 1);
+    // Convert the counts of the characters that appear into the map
+    Map<int, int> freqTable;
+    for (int currChar = 0; currChar <= PSEUDO_EOF; currChar++) {
+        if (counts[currChar] > INT_MAX) {
+            error("buildFrequencyTable: a character appears too often to be counted");
+        }
+        if (counts[currChar] > 0) {
+            freqTable.put(currChar, counts[currChar]);
         }
-
-        // Update currChar
-        currChar = input.get();
     }
 
-    // Add PSEUDO_EOF
-    freqTable.put(PSEUDO_EOF, 1);
-
     return freqTable;
 }
 
@@ -136,15 +173,93 @@ Map<int, string> buildEncodingMap(HuffmanNode* encodingTree) {
     return encodingMap;
 }
 
+// Number of bytes collected before they are written to the output stream
+const int OUTPUT_BUFFER_SIZE = 1 << 16;
+
+/*
+ * The encoding of one character as an integer, for encodeData. The first bit
+ * of the code is the lowest bit of bits, because obitstream fills each byte
+ * from its lowest bit up, so codes can be shifted into place in a whole word.
+ */
+struct HuffmanCode {
+    uint64_t bits;
+    int length;
+};
+
 /*
- * Writes string to binary stream bit by bit
+ * Helper function to encodeData which converts the encoding map into a flat
+ * table indexed by character, with PSEUDO_EOF as the last entry. Characters
+ * that are not in the map get an empty code, as encodingMap.get would give.
  */
-void writeStringToBinFile(obitstream& output, string& binVal) {
-    for (int i = 0; i < binVal.size(); i++) {
-        output.writeBit(charToInteger(binVal[i]));
+void buildCodeTable(const Map<int, string>& encodingMap, HuffmanCode codeTable[PSEUDO_EOF + 1]) {
+    for (int currChar = 0; currChar <= PSEUDO_EOF; currChar++) {
+        string binVal = encodingMap.get(currChar);
+        if (binVal.size() > 64) {
+            error("encodeData: an encoding is too long to fit in a 64-bit word");
+        }
+
+        codeTable[currChar].bits = 0;
+        codeTable[currChar].length = binVal.size();
+        for (int i = 0; i < (int) binVal.size(); i++) {
+            if (binVal[i] == '1') {
+                codeTable[currChar].bits |= uint64_t(1) << i;
+            }
+        }
     }
 }
 
+/*
+ * Collects codes into a 64-bit word, and full words into a buffer of bytes
+ * that is written to the output stream whenever it fills up, so the stream is
+ * called once per buffer instead of once per bit. The bytes come out exactly
+ * as obitstream::writeBit would have written them, including the zero bits
+ * that pad the last byte, as long as the output starts at a byte boundary.
+ */
+struct BitWriter {
+    ostream& output;
+    vector<char> buffer;
+    int numBuffered;
+    uint64_t word;
+    int numBits;
+
+    BitWriter(ostream& output)
+        : output(output), buffer(OUTPUT_BUFFER_SIZE), numBuffered(0), word(0), numBits(0) {
+    }
+
+    // Adds the code after the bits written so far
+    void write(const HuffmanCode& code) {
+        word |= code.bits << numBits;
+        numBits += code.length;
+        if (numBits >= 64) {
+            writeBytes(8);
+
+            // Start the next word with the bits of the code that did not fit
+            numBits -= 64;
+            word = numBits == 0 ? 0 : code.bits >> (code.length - numBits);
+        }
+    }
+
+    // Writes out the bits left in the word and everything still in the buffer
+    void flush() {
+        writeBytes((numBits + 7) / 8);
+        word = 0;
+        numBits = 0;
+        output.write(buffer.data(), numBuffered);
+        numBuffered = 0;
+    }
+
+    // Moves the lowest bytes of the word into the buffer, lowest byte first
+    void writeBytes(int numBytes) {
+        if (numBuffered + numBytes > OUTPUT_BUFFER_SIZE) {
+            output.write(buffer.data(), numBuffered);
+            numBuffered = 0;
+        }
+        for (int i = 0; i < numBytes; i++) {
+            buffer[numBuffered++] = char(word >> (8 * i));
+        }
+    }
+};
+
 /*
  * This function reads one character at a time from a given input file, and uses the
  * provided encoding map to encode each character to binary, then writes the
@@ -153,29 +268,34 @@ void writeStringToBinFile(obitstream& output, string& binVal) {
  * encoding for PSEUDO_EOF into the output. It assumes that the parameters
  * are valid: that the encoding map is valid and contains all needed data, that the
  * input stream is readable, and that the output stream is writable. The streams are
- * already opened and ready to be read/written.
+ * already opened and ready to be read/written, and no bits have been written to
+ * the output yet other than whole bytes (such as the header compress writes).
+ * The input is read in large chunks and each character's code is looked up in
+ * a flat table, so that whole bytes rather than single bits go to the output.
  */
 void encodeData(istream& input, const Map<int, string>& encodingMap, obitstream& output) {
 
     // Rewind stream
     rewindStream(input);
 
-    // Initialize the currChar from istream
-    int currChar = input.get();
-
-    // Loop over file and get characters one by one
-    while (currChar != -1) {
-        string binVal = encodingMap.get(currChar);
-        writeStringToBinFile(output, binVal);
-
-        // Update currChar
-        currChar = input.get();
+    // Look up every code once, up front
+    HuffmanCode codeTable[PSEUDO_EOF + 1];
+    buildCodeTable(encodingMap, codeTable);
+
+    // Encode every chunk of the input
+    BitWriter writer(output);
+    vector<unsigned char> buffer(CHUNK_SIZE);
+    while (input) {
+        input.read(reinterpret_cast<char*>(buffer.data()), CHUNK_SIZE);
+        int numRead = input.gcount();
+        for (int i = 0; i < numRead; i++) {
+            writer.write(codeTable[buffer[i]]);
+        }
     }
 
     // Add the PSEUDO_EOF key
-    string binVal = encodingMap.get(PSEUDO_EOF);
-    writeStringToBinFile(output, binVal);
-
+    writer.write(codeTable[PSEUDO_EOF]);
+    writer.flush();
 }
 
 /*
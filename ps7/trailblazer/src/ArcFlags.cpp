@@ -0,0 +1,197 @@
+/*
+ * This sourcecode file implements the ArcFlags class declared in ArcFlags.h.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+#include <thread>
+
+#include "error.h"
+#include "ArcFlags.h"
+#include "IndexedHeap.h"
+using namespace std;
+
+ArcFlags::ArcFlags(const RoadGraph& graph, int numRegions, int numThreads)
+    : graph(graph.compact()),
+      numRegions(0) {
+
+    if (numRegions < 1 or numRegions > MAX_REGIONS) {
+        error("ArcFlags: the number of regions must be between 1 and 64");
+    }
+
+    int numNodes = this->graph.nodeCount();
+    int numEdges = this->graph.edgeCount();
+    this->numRegions = max(1, min(numRegions, numNodes));
+
+    vector<int> nodeRegions(numNodes, 0);
+    vector<int> nodes(numNodes);
+    iota(nodes.begin(), nodes.end(), 0);
+    if (numNodes > 0) {
+        partition(nodes, 0, numNodes, 0, this->numRegions, nodeRegions);
+    }
+    regions = FlatArray<int>(move(nodeRegions));
+
+    // Edges inside a region lead toward it; the head of an edge entering a region is a boundary node
+    vector<uint64_t> edgeFlags(numEdges, 0);
+    vector<char> isBoundary(numNodes, false);
+    for (int node = 0; node < numNodes; node++) {
+        for (int edge = this->graph.firstEdge(node); edge < this->graph.endEdge(node); edge++) {
+            int target = this->graph.edgeTarget(edge);
+            if (regions[target] == regions[node]) {
+                edgeFlags[edge] |= uint64_t(1) << regions[node];
+            }
+            else {
+                isBoundary[target] = true;
+            }
+        }
+    }
+    vector<int> boundary;
+    for (int node = 0; node < numNodes; node++) {
+        if (isBoundary[node]) {
+            boundary.push_back(node);
+        }
+    }
+
+    // Each thread takes every numThreads-th boundary node and ORs its trees into flags of its own
+    if (numThreads <= 0) {
+        numThreads = max(1, (int) thread::hardware_concurrency());
+    }
+    numThreads = max(1, min(numThreads, (int) boundary.size()));
+    vector<vector<uint64_t>> threadFlags(numThreads, vector<uint64_t>(numEdges, 0));
+    vector<thread> workers;
+    for (int ii = 0; ii < numThreads; ii++) {
+        workers.emplace_back(&ArcFlags::flagTrees, this, cref(boundary), ii, numThreads, ref(threadFlags[ii]));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    for (const vector<uint64_t>& treeFlags : threadFlags) {
+        for (int edge = 0; edge < numEdges; edge++) {
+            edgeFlags[edge] |= treeFlags[edge];
+        }
+    }
+    flags = FlatArray<uint64_t>(move(edgeFlags));
+}
+
+ArcFlags::ArcFlags(const CompactRoadGraph& graph)
+    : graph(graph),
+      numRegions(0) {
+    // Everything else handled by default
+}
+
+const CompactRoadGraph& ArcFlags::compactGraph() const {
+    return graph;
+}
+
+int ArcFlags::regionCount() const {
+    return numRegions;
+}
+
+int ArcFlags::regionOf(int node) const {
+    return regions[node];
+}
+
+double ArcFlags::flaggedShare(int region) const {
+    if (flags.empty()) {
+        return 0.0;
+    }
+    int numFlagged = 0;
+    for (uint64_t edgeFlags : flags) {
+        numFlagged += (edgeFlags >> region) & 1;
+    }
+    return double(numFlagged) / flags.size();
+}
+
+/*
+ * A k-d split: the range is cut at the median of the coordinate along which it is widest,
+ * with each side getting nodes in proportion to the regions it still has to make, so that
+ * any number of regions comes out balanced.
+ */
+void ArcFlags::partition(vector<int>& nodes, int first, int last, int firstRegion, int count,
+                         vector<int>& nodeRegions) const {
+
+    if (count == 1) {
+        for (int ii = first; ii < last; ii++) {
+            nodeRegions[nodes[ii]] = firstRegion;
+        }
+        return;
+    }
+
+    double minX = DBL_MAX, maxX = -DBL_MAX, minY = DBL_MAX, maxY = -DBL_MAX;
+    for (int ii = first; ii < last; ii++) {
+        Point location = graph.nodeAt(nodes[ii])->location();
+        minX = min(minX, location.getX());
+        maxX = max(maxX, location.getX());
+        minY = min(minY, location.getY());
+        maxY = max(maxY, location.getY());
+    }
+    bool splitX = maxX - minX >= maxY - minY;
+
+    // Ties are broken by ID so that the same graph is always split the same way
+    auto before = [&](int a, int b) {
+        Point locationA = graph.nodeAt(a)->location();
+        Point locationB = graph.nodeAt(b)->location();
+        double coordinateA = splitX ? locationA.getX() : locationA.getY();
+        double coordinateB = splitX ? locationB.getX() : locationB.getY();
+        return coordinateA < coordinateB or (coordinateA == coordinateB and a < b);
+    };
+
+    int leftCount = count / 2;
+    int middle = first + int((long long)(last - first) * leftCount / count);
+    nth_element(nodes.begin() + first, nodes.begin() + middle, nodes.begin() + last, before);
+
+    partition(nodes, first, middle, firstRegion, leftCount, nodeRegions);
+    partition(nodes, middle, last, firstRegion + leftCount, count - leftCount, nodeRegions);
+}
+
+/*
+ * A plain backward Dijkstra search from each boundary node, like Landmarks::distancesFrom,
+ * followed by a pass over the in-edges of every node it settled.  The edge that set a
+ * node's distance is exactly tight, so every node keeps a fully flagged shortest path to
+ * the boundary node; edges that tie with it are flagged too.  Only the settled nodes are
+ * reset between searches.
+ */
+void ArcFlags::flagTrees(const vector<int>& boundary, int firstIndex, int step,
+                         vector<uint64_t>& treeFlags) const {
+
+    vector<double> distances(graph.nodeCount(), DBL_MAX);
+    vector<int> settled;
+    IndexedHeap openSet(graph.nodeCount(), IndexedHeap::DEFAULT_ARITY);
+
+    for (size_t ii = firstIndex; ii < boundary.size(); ii += step) {
+
+        int root = boundary[ii];
+        uint64_t regionFlag = uint64_t(1) << regions[root];
+        distances[root] = 0.0;
+        openSet.enqueue(root, 0.0);
+
+        while (!openSet.isEmpty()) {
+            int node = openSet.dequeue();
+            settled.push_back(node);
+            double currCost = distances[node];
+
+            for (int inEdge = graph.firstInEdge(node); inEdge < graph.endInEdge(node); inEdge++) {
+                int source = graph.inEdgeSource(inEdge);
+                double updatedCost = currCost + graph.inEdgeCost(inEdge);
+                if (updatedCost < distances[source]) {
+                    distances[source] = updatedCost;
+                    openSet.enqueueOrDecrease(source, updatedCost);
+                }
+            }
+        }
+
+        for (int node : settled) {
+            for (int inEdge = graph.firstInEdge(node); inEdge < graph.endInEdge(node); inEdge++) {
+                if (distances[graph.inEdgeSource(inEdge)] == distances[node] + graph.inEdgeCost(inEdge)) {
+                    treeFlags[graph.inEdgeToEdge(inEdge)] |= regionFlag;
+                }
+            }
+        }
+
+        for (int node : settled) {
+            distances[node] = DBL_MAX;
+        }
+        settled.clear();
+    }
+}
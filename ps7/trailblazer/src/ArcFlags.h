@@ -0,0 +1,108 @@
+/*
+ * This header declares the ArcFlags class, which lets Dijkstra's algorithm and A* skip
+ * edges that cannot lie on a shortest path to the region the search is headed for.
+ *
+ * The map is split into regions of about equal size, by repeatedly halving the nodes at
+ * the median of their wider coordinate.  Every edge then gets one flag per region, set
+ * if the edge starts a shortest path to some node of that region.  A search for a target
+ * in region r only relaxes edges whose flag r is set; every shortest path to the target
+ * keeps those flags along its whole length, so the search still finds one, while most of
+ * the map that lies away from the target is never entered.
+ *
+ * To set the flags of region r, a backward Dijkstra search is run from each boundary
+ * node of r (each node of r entered by an edge from outside it), and every edge that is
+ * tight in one of the resulting trees gets flag r; so does every edge inside r.  That is
+ * one full search per boundary node, which makes the preprocessing far more expensive
+ * than building landmarks, so it is spread over several threads.  The flags take one
+ * 64-bit word per edge, much less than any all-pairs table.
+ *
+ * The flags are built from the graph's CSR snapshot and must be rebuilt if edges are
+ * added to the graph or their costs change.  Pass them to the searches through
+ * SearchOptions::arcFlags; a RoutingIndex file keeps them between runs.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CompactRoadGraph.h"
+#include "FlatArray.h"
+#include "RoadGraph.h"
+
+class ArcFlags {
+public:
+    /* Number of regions made when no count is given, and the most there can be. */
+    static const int DEFAULT_REGIONS = 32;
+    static const int MAX_REGIONS = 64;
+
+    /*
+     * Splits the graph into the given number of regions (or one per node, in graphs with
+     * fewer nodes) and computes the flags of every edge, using the given number of threads
+     * (one per hardware thread if 0 or less).
+     */
+    explicit ArcFlags(const RoadGraph& graph, int numRegions = DEFAULT_REGIONS, int numThreads = 0);
+
+    /*
+     * Returns the CSR snapshot whose dense node and edge IDs the flags use.
+     */
+    const CompactRoadGraph& compactGraph() const;
+
+    /*
+     * Returns the number of regions.
+     */
+    int regionCount() const;
+
+    /*
+     * Returns the region of the node with the given dense ID.
+     */
+    int regionOf(int node) const;
+
+    /*
+     * Returns whether the edge with the given index can lie on a shortest path to a node
+     * in the given region.
+     */
+    bool allows(int edge, int region) const;
+
+    /*
+     * Returns the share of the edges (from 0 to 1) that have the given region's flag set.
+     */
+    double flaggedShare(int region) const;
+
+private:
+    const CompactRoadGraph& graph;
+    FlatArray<int> regions;          // dense ID -> region
+    FlatArray<uint64_t> flags;       // edge index -> bit r set if the edge leads toward region r
+    int numRegions;
+
+    /* A RoutingIndex fills in the tables of the arc flags it loads. */
+    friend class RoutingIndex;
+
+    /*
+     * Constructs arc flags over the given snapshot with empty tables, for a RoutingIndex
+     * to fill in.
+     */
+    explicit ArcFlags(const CompactRoadGraph& graph);
+
+    /*
+     * Assigns the nodes in [first, last) of the given list to count regions, starting with
+     * region firstRegion, recording each node's region in nodeRegions.
+     */
+    void partition(std::vector<int>& nodes, int first, int last, int firstRegion, int count,
+                   std::vector<int>& nodeRegions) const;
+
+    /*
+     * Sets the flags of the edges that are tight in a backward shortest-path tree to each
+     * of the given boundary nodes (in the given share of them), ORing them into the given
+     * flags.
+     */
+    void flagTrees(const std::vector<int>& boundary, int firstIndex, int step,
+                   std::vector<uint64_t>& treeFlags) const;
+};
+
+/*
+ * allows() is called once per relaxed edge, so it is defined here where the compiler can
+ * inline it.
+ */
+inline bool ArcFlags::allows(int edge, int region) const {
+    return (flags[edge] >> region) & 1;
+}
@@ -0,0 +1,152 @@
+/*
+ * This sourcecode file implements the BatchSearch class declared in BatchSearch.h.
+ */
+
+#include <algorithm>
+
+#include "BatchSearch.h"
+#include "CompactRoadGraph.h"
+using namespace std;
+
+/*
+ * Number of queries a worker claims at once.  Claiming several at a time keeps the
+ * workers from contending for the lock after every short query.
+ */
+static const int QUERIES_PER_CLAIM = 8;
+
+BatchSearch::BatchSearch(const RoadGraph& graph, int numThreads)
+    : graph(graph),
+      queries(nullptr),
+      search(nullptr),
+      results(nullptr),
+      nextQuery(0),
+      numBusyWorkers(0),
+      batchNumber(0),
+      stopping(false) {
+
+    // Building the graph's CSR snapshot up front, since the workers must only read it
+    graph.compact();
+
+    if (numThreads <= 0) {
+        numThreads = max(1, (int)thread::hardware_concurrency());
+    }
+    for (int ii = 0; ii < numThreads; ii++) {
+        workers.emplace_back(&BatchSearch::workerLoop, this);
+    }
+}
+
+BatchSearch::~BatchSearch() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    batchReady.notify_all();
+
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int BatchSearch::threadCount() const {
+    return workers.size();
+}
+
+Vector<Path> BatchSearch::run(const Vector<RouteQuery>& queries, SearchFunction search,
+                              const SearchOptions& options) {
+
+    Vector<Path> results(queries.size());
+    if (queries.isEmpty()) {
+        return results;
+    }
+
+    unique_lock<mutex> guard(lock);
+    this->queries = &queries;
+    this->search = search;
+    this->options = options;
+    this->options.headless = true;
+    this->results = &results;
+    nextQuery = 0;
+    numBusyWorkers = workers.size();
+    batchNumber++;
+    failure = nullptr;
+
+    batchReady.notify_all();
+    batchDone.wait(guard, [this]() { return numBusyWorkers == 0; });
+
+    this->queries = nullptr;
+    this->results = nullptr;
+    if (failure) {
+        rethrow_exception(failure);
+    }
+    return results;
+}
+
+void BatchSearch::workerLoop() {
+
+    int lastBatch = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(lock);
+            batchReady.wait(guard, [this, lastBatch]() { return stopping or batchNumber != lastBatch; });
+            if (stopping) {
+                return;
+            }
+            lastBatch = batchNumber;
+        }
+
+        runQueries();
+
+        lock_guard<mutex> guard(lock);
+        if (--numBusyWorkers == 0) {
+            batchDone.notify_all();
+        }
+    }
+}
+
+/*
+ * A worker counts into counters of its own, since the searches update them without any
+ * locking, and adds its totals to the caller's counters when it runs out of queries.
+ */
+void BatchSearch::runQueries() {
+
+    SearchCounters workerCounters;
+    SearchOptions workerOptions = options;
+    if (options.counters != nullptr) {
+        workerOptions.counters = &workerCounters;
+    }
+
+    while (true) {
+        int first, last;
+        {
+            lock_guard<mutex> guard(lock);
+            if (failure) {
+                break;
+            }
+            first = nextQuery;
+            last = min(first + QUERIES_PER_CLAIM, queries->size());
+            nextQuery = last;
+        }
+        if (first >= last) {
+            break;
+        }
+
+        try {
+            for (int ii = first; ii < last; ii++) {
+                const RouteQuery& query = (*queries)[ii];
+                (*results)[ii] = search(graph, query.start, query.end, workerOptions);
+            }
+        }
+        catch (...) {
+            lock_guard<mutex> guard(lock);
+            if (!failure) {
+                failure = current_exception();
+            }
+            break;
+        }
+    }
+
+    if (options.counters != nullptr) {
+        lock_guard<mutex> guard(lock);
+        options.counters->add(workerCounters);
+    }
+}
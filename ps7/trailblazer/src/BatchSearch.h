@@ -0,0 +1,97 @@
+/*
+ * This header declares the BatchSearch class, which answers many shortest-path queries
+ * against one RoadGraph in parallel.
+ *
+ * A BatchSearch owns a fixed pool of worker threads.  Each call to run() hands the workers
+ * a list of origin / destination pairs, which they claim a few at a time until none are
+ * left, so a handful of long queries cannot leave the other threads idle.  Every worker
+ * keeps its own search tables and heaps (see SearchSpace::reusable()), and these survive
+ * from one batch to the next because the threads do.  The searches run headless, so no
+ * node colors or observer notifications are involved and nothing is shared between the
+ * threads except the read-only graph.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "vector.h"
+#include "RoadGraph.h"
+#include "SearchOptions.h"
+#include "Trailblazer.h"
+
+/*
+ * One origin / destination pair.
+ */
+struct RouteQuery {
+    RoadNode* start;
+    RoadNode* end;
+};
+
+/* Signature shared by the variants of the searches in Trailblazer.h that take options. */
+using SearchFunction = Path (*)(const RoadGraph& graph, RoadNode* start, RoadNode* end,
+                                const SearchOptions& options);
+
+class BatchSearch {
+public:
+    /*
+     * Starts the given number of worker threads for queries on the given graph, or one per
+     * hardware thread if numThreads is not positive.
+     */
+    explicit BatchSearch(const RoadGraph& graph, int numThreads = 0);
+
+    /*
+     * Stops and joins the worker threads.
+     */
+    ~BatchSearch();
+
+    /*
+     * Returns the number of worker threads.
+     */
+    int threadCount() const;
+
+    /*
+     * Runs the given search for every query and returns the paths in the same order as the
+     * queries.  The options apply to every search, except that they always run headless;
+     * any counters they carry receive the totals for the whole batch (their elapsedMs adds
+     * up the time of every search, across all of the threads).
+     * An error raised by any of the searches is rethrown here once the batch has stopped.
+     * Only one batch may run at a time.
+     */
+    Vector<Path> run(const Vector<RouteQuery>& queries, SearchFunction search,
+                     const SearchOptions& options = SearchOptions());
+
+private:
+    const RoadGraph& graph;
+    std::vector<std::thread> workers;
+
+    /* The batch being worked on.  All of these are guarded by lock, except the results,
+     * whose entries are each written by exactly one worker.
+     */
+    std::mutex lock;
+    std::condition_variable batchReady;     // signalled when a batch starts or the pool stops
+    std::condition_variable batchDone;      // signalled when the last worker finishes a batch
+    const Vector<RouteQuery>* queries;
+    SearchFunction search;
+    SearchOptions options;
+    Vector<Path>* results;
+    int nextQuery;                          // index of the first query no worker has claimed
+    int numBusyWorkers;
+    int batchNumber;
+    bool stopping;
+    std::exception_ptr failure;             // first error raised by a search in this batch
+
+    /*
+     * The body of each worker thread: waits for a batch, helps to finish it, and repeats
+     * until the pool stops.
+     */
+    void workerLoop();
+
+    /*
+     * Claims and runs queries from the current batch until none are left.
+     */
+    void runQueries();
+};
@@ -0,0 +1,135 @@
+/*
+ * This sourcecode file implements the CompactRoadGraph class declared in CompactRoadGraph.h.
+ */
+
+#include "CompactRoadGraph.h"
+using namespace std;
+
+/*
+ * Builds the CSR arrays in two passes: the first assigns every node its dense index, and
+ * the second appends each node's outgoing edges in index order, so that the offsets array
+ * is simply a running count of the edges written so far.
+ */
+CompactRoadGraph::CompactRoadGraph(const Graph<RoadNode, RoadEdge>& data) {
+
+    for (RoadNode* node : data.getNodeSet()) {
+        indices.put(node, nodes.size());
+        nodes.add(node);
+        xs.push_back(node->location().getX());
+        ys.push_back(node->location().getY());
+    }
+
+    int numEdges = data.getArcSet().size();
+    offsets.reserve(nodes.size() + 1);
+    targets.reserve(numEdges);
+    costs.reserve(numEdges);
+    edges.reserve(numEdges);
+
+    offsets.push_back(0);
+    for (RoadNode* node : nodes) {
+        for (RoadEdge* edge : data.getArcSet(node)) {
+            targets.push_back(indices.get(edge->to()));
+            costs.push_back(edge->cost());
+            edges.push_back(edge);
+        }
+        offsets.push_back(targets.size());
+    }
+
+    buildIncomingEdges();
+}
+
+/*
+ * Groups the edges by target with a counting sort: count the edges entering each node,
+ * turn the counts into starting offsets, then drop every edge into the next free slot of
+ * its target's range.
+ */
+void CompactRoadGraph::buildIncomingEdges() {
+
+    int numNodes = nodeCount();
+    int numEdges = edgeCount();
+
+    inOffsets.assign(numNodes + 1, 0);
+    for (int edge = 0; edge < numEdges; edge++) {
+        inOffsets[targets[edge] + 1]++;
+    }
+    for (int node = 0; node < numNodes; node++) {
+        inOffsets[node + 1] += inOffsets[node];
+    }
+
+    sources.resize(numEdges);
+    inCosts.resize(numEdges);
+    inEdgeIds.resize(numEdges);
+
+    vector<int> nextSlot(inOffsets.begin(), inOffsets.end() - 1);
+    for (int node = 0; node < numNodes; node++) {
+        for (int edge = offsets[node]; edge < offsets[node + 1]; edge++) {
+            int slot = nextSlot[targets[edge]]++;
+            sources[slot] = node;
+            inCosts[slot] = costs[edge];
+            inEdgeIds[slot] = edge;
+        }
+    }
+}
+
+int CompactRoadGraph::nodeCount() const {
+    return nodes.size();
+}
+
+int CompactRoadGraph::edgeCount() const {
+    return targets.size();
+}
+
+int CompactRoadGraph::indexOf(RoadNode* node) const {
+    if (!indices.containsKey(node)) {
+        return NO_NODE;
+    }
+    return indices.get(node);
+}
+
+RoadNode* CompactRoadGraph::nodeAt(int index) const {
+    return nodes[index];
+}
+
+RoadEdge* CompactRoadGraph::edgeAt(int edge) const {
+    return edges[edge];
+}
+
+int CompactRoadGraph::inEdgeToEdge(int inEdge) const {
+    return inEdgeIds[inEdge];
+}
+
+int CompactRoadGraph::edgeIndexOf(RoadEdge* edge) const {
+    int node = indexOf(edge->from());
+    if (node == NO_NODE) {
+        return NO_EDGE;
+    }
+    for (int ii = offsets[node]; ii < offsets[node + 1]; ii++) {
+        if (edges[ii] == edge) {
+            return ii;
+        }
+    }
+    return NO_EDGE;
+}
+
+void CompactRoadGraph::setEdgeCost(int edge, double cost) {
+    costs[edge] = cost;
+    int target = targets[edge];
+    for (int ii = inOffsets[target]; ii < inOffsets[target + 1]; ii++) {
+        if (inEdgeIds[ii] == edge) {
+            inCosts[ii] = cost;
+            return;
+        }
+    }
+}
+
+void CompactRoadGraph::crowFlyDistancesTo(int target, vector<double>& distances) const {
+    int numNodes = nodeCount();
+    double targetX = xs[target];
+    double targetY = ys[target];
+    distances.resize(numNodes);
+    for (int node = 0; node < numNodes; node++) {
+        double dx = xs[node] - targetX;
+        double dy = ys[node] - targetY;
+        distances[node] = sqrt(dx * dx + dy * dy) - 1;
+    }
+}
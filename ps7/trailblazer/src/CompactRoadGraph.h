@@ -0,0 +1,204 @@
+/*
+ * This header declares the CompactRoadGraph class, a read-only compressed-sparse-row
+ * (CSR) snapshot of a Graph<RoadNode, RoadEdge>.  Every node is given a dense index
+ * from 0 to nodeCount() - 1, and the outgoing edges of node v occupy the contiguous
+ * range [firstEdge(v), endEdge(v)) of flat target / cost arrays.  Searches can walk
+ * those arrays directly, with no allocation and no map lookups per relaxed edge.
+ * A second, reversed set of arrays lists the edges entering each node, for searches
+ * that run backward from their destination.
+ *
+ * The snapshot is built once per graph (see RoadGraph::compact()) and must be rebuilt
+ * if nodes or edges are added to the underlying graph afterwards.  Edge costs can change
+ * in place; RoadGraph::setEdgeCost() keeps the snapshot in step with the graph.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include "graph.h"
+#include "hashmap.h"
+#include "vector.h"
+#include "RoadGraph.h"
+
+class CompactRoadGraph {
+public:
+    /* Index reported for nodes that are not part of the snapshot. */
+    static const int NO_NODE = -1;
+
+    /* Index reported for edges that are not part of the snapshot. */
+    static const int NO_EDGE = -1;
+
+    /*
+     * Builds the snapshot from every node and edge currently in the given graph.
+     */
+    explicit CompactRoadGraph(const Graph<RoadNode, RoadEdge>& data);
+
+    /*
+     * Returns the number of nodes / edges in the snapshot.
+     */
+    int nodeCount() const;
+    int edgeCount() const;
+
+    /*
+     * Returns the dense index of the given node, or NO_NODE if it is not in the graph.
+     */
+    int indexOf(RoadNode* node) const;
+
+    /*
+     * Returns the node with the given dense index.
+     */
+    RoadNode* nodeAt(int index) const;
+
+    /*
+     * Returns the bounds of the half-open range of edge indices leaving the given node.
+     */
+    int firstEdge(int node) const;
+    int endEdge(int node) const;
+
+    /*
+     * Returns the dense index of the node that the given edge enters.
+     */
+    int edgeTarget(int edge) const;
+
+    /*
+     * Returns the cost of the given edge.
+     */
+    double edgeCost(int edge) const;
+
+    /*
+     * Returns the RoadEdge that the given edge index was built from.
+     */
+    RoadEdge* edgeAt(int edge) const;
+
+    /*
+     * Returns the edge index the given RoadEdge was stored at, or NO_EDGE if it is not in
+     * the snapshot.  This scans the edges leaving its start node.
+     */
+    int edgeIndexOf(RoadEdge* edge) const;
+
+    /*
+     * Changes the cost of the given edge, in both the outgoing and the incoming arrays.
+     */
+    void setEdgeCost(int edge, double cost);
+
+    /*
+     * Returns the bounds of the half-open range of incoming-edge indices entering the
+     * given node. Incoming-edge indices are separate from (outgoing) edge indices.
+     */
+    int firstInEdge(int node) const;
+    int endInEdge(int node) const;
+
+    /*
+     * Returns the dense index of the node that the given incoming edge leaves.
+     */
+    int inEdgeSource(int inEdge) const;
+
+    /*
+     * Returns the cost of the given incoming edge.
+     */
+    double inEdgeCost(int inEdge) const;
+
+    /*
+     * Returns the (outgoing) edge index of the given incoming edge.
+     */
+    int inEdgeToEdge(int inEdge) const;
+
+    /*
+     * Returns the crow-fly distance between two nodes, exactly as
+     * RoadGraph::crowFlyDistanceBetween() computes it, but from the coordinates copied
+     * into the snapshot rather than from the nodes themselves.
+     */
+    double crowFlyDistance(int from, int to) const;
+
+    /*
+     * Returns the true Euclidean distance between two nodes, without the -1 that
+     * crowFlyDistance() inherits from RoadGraph.  Use this where the distance is a
+     * quantity in its own right (such as a route's length) rather than a heuristic.
+     */
+    double euclideanDistance(int from, int to) const;
+
+    /*
+     * Fills distances with the crow-fly distance from every node to the target, indexed by
+     * dense index.  This is a single branch-free pass over the coordinate arrays, which the
+     * compiler can vectorize.
+     */
+    void crowFlyDistancesTo(int target, std::vector<double>& distances) const;
+
+private:
+    HashMap<RoadNode*, int> indices;   // node -> dense index
+    Vector<RoadNode*> nodes;           // dense index -> node
+
+    /* The CSR arrays themselves. These are std::vectors rather than Vectors so that the
+     * hot loops in the searches do not pay for bounds checks.
+     */
+    std::vector<int> offsets;          // nodeCount() + 1 entries; edges of v are [offsets[v], offsets[v + 1])
+    std::vector<int> targets;          // edge -> dense index of the node it enters
+    std::vector<double> costs;         // edge -> cost
+    std::vector<RoadEdge*> edges;      // edge -> original RoadEdge
+    std::vector<double> xs;            // dense index -> x / y coordinate of the node's location()
+    std::vector<double> ys;
+
+    /* The same edges grouped by the node they enter. */
+    std::vector<int> inOffsets;        // nodeCount() + 1 entries; in-edges of v are [inOffsets[v], inOffsets[v + 1])
+    std::vector<int> sources;          // in-edge -> dense index of the node it leaves
+    std::vector<double> inCosts;       // in-edge -> cost
+    std::vector<int> inEdgeIds;        // in-edge -> edge index
+
+    /*
+     * Fills in the incoming-edge arrays from the outgoing ones.
+     */
+    void buildIncomingEdges();
+};
+
+/*
+ * The accessors are called once per relaxed edge, so they are defined here where the
+ * compiler can inline them.
+ */
+inline int CompactRoadGraph::firstEdge(int node) const {
+    return offsets[node];
+}
+
+inline int CompactRoadGraph::endEdge(int node) const {
+    return offsets[node + 1];
+}
+
+inline int CompactRoadGraph::edgeTarget(int edge) const {
+    return targets[edge];
+}
+
+inline double CompactRoadGraph::edgeCost(int edge) const {
+    return costs[edge];
+}
+
+inline int CompactRoadGraph::firstInEdge(int node) const {
+    return inOffsets[node];
+}
+
+inline int CompactRoadGraph::endInEdge(int node) const {
+    return inOffsets[node + 1];
+}
+
+inline int CompactRoadGraph::inEdgeSource(int inEdge) const {
+    return sources[inEdge];
+}
+
+inline double CompactRoadGraph::inEdgeCost(int inEdge) const {
+    return inCosts[inEdge];
+}
+
+/*
+ * The -1 matches the workaround in RoadGraph's pointDistance(); the heuristics must agree
+ * with RoadGraph::maxRoadSpeed(), which is computed with it.
+ */
+inline double CompactRoadGraph::crowFlyDistance(int from, int to) const {
+    double dx = xs[from] - xs[to];
+    double dy = ys[from] - ys[to];
+    return std::sqrt(dx * dx + dy * dy) - 1;
+}
+
+inline double CompactRoadGraph::euclideanDistance(int from, int to) const {
+    double dx = xs[from] - xs[to];
+    double dy = ys[from] - ys[to];
+    return std::sqrt(dx * dx + dy * dy);
+}
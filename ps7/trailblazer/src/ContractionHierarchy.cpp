@@ -0,0 +1,529 @@
+/*
+ * This sourcecode file implements the ContractionHierarchy class declared in
+ * ContractionHierarchy.h.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "error.h"
+#include "ContractionHierarchy.h"
+using namespace std;
+
+/* Private types and helper functions only needed in this file. */
+namespace {
+    /*
+     * The most nodes a witness search may settle before giving up.  Giving up early only
+     * costs an unnecessary shortcut, never a wrong answer.
+     */
+    const int WITNESS_SETTLE_LIMIT = 500;
+
+    /*
+     * An edge of the graph that remains during contraction, seen from one of its ends.
+     */
+    struct Link {
+        int node;     // node at the other end
+        double cost;
+        int arc;      // index of the hierarchy arc this link stands for
+    };
+
+    using LinkLists = vector<vector<Link>>;
+
+    /*
+     * A Dijkstra search used while contracting a node v, which checks whether two of its
+     * neighbors are connected at least as cheaply without going through v (a "witness").
+     */
+    class WitnessSearch {
+    public:
+        explicit WitnessSearch(int numNodes) : distances(numNodes, DBL_MAX) {}
+
+        /*
+         * Searches from source over the remaining graph, never entering the node being
+         * contracted, until every node closer than maxCost is settled or the settle limit
+         * is reached.
+         */
+        void run(const LinkLists& outLinks, const vector<bool>& contracted, int source,
+                 int skipped, double maxCost) {
+
+            // Only the entries written by the previous run need to be reset
+            for (int node : touched) {
+                distances[node] = DBL_MAX;
+            }
+            touched.clear();
+
+            using Entry = pair<double, int>;
+            priority_queue<Entry, vector<Entry>, greater<Entry>> queue;
+            distances[source] = 0.0;
+            touched.push_back(source);
+            queue.push({0.0, source});
+
+            int numSettled = 0;
+            while (!queue.empty()) {
+                Entry front = queue.top();
+                queue.pop();
+
+                int node = front.second;
+                if (front.first > distances[node]) {
+                    continue;
+                }
+                if (front.first > maxCost or ++numSettled > WITNESS_SETTLE_LIMIT) {
+                    break;
+                }
+
+                for (const Link& link : outLinks[node]) {
+                    if (link.node == skipped or contracted[link.node]) {
+                        continue;
+                    }
+                    double updatedCost = front.first + link.cost;
+                    if (updatedCost < distances[link.node]) {
+                        if (distances[link.node] == DBL_MAX) {
+                            touched.push_back(link.node);
+                        }
+                        distances[link.node] = updatedCost;
+                        queue.push({updatedCost, link.node});
+                    }
+                }
+            }
+        }
+
+        /*
+         * Returns the cost of the cheapest witness found to the node, or infinity.
+         */
+        double distanceTo(int node) const {
+            return distances[node];
+        }
+
+    private:
+        vector<double> distances;
+        vector<int> touched;
+    };
+
+    /*
+     * Returns the link to the given node in the list, or nullptr if there is none.
+     */
+    Link* findLink(vector<Link>& links, int node) {
+        for (Link& link : links) {
+            if (link.node == node) {
+                return &link;
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+     * Removes the link to the given node from the list, if there is one.
+     */
+    void removeLink(vector<Link>& links, int node) {
+        links.erase(remove_if(links.begin(), links.end(),
+                              [node](const Link& link) { return link.node == node; }),
+                    links.end());
+    }
+}
+
+ContractionHierarchy::ContractionHierarchy(const RoadGraph& graph)
+    : graph(graph.compact()),
+      numShortcuts(0) {
+
+    contractAll();
+}
+
+ContractionHierarchy::ContractionHierarchy(const CompactRoadGraph& graph)
+    : graph(graph),
+      numShortcuts(0) {
+    // Everything else handled by default
+}
+
+const CompactRoadGraph& ContractionHierarchy::compactGraph() const {
+    return graph;
+}
+
+int ContractionHierarchy::rankOf(int node) const {
+    return ranks[node];
+}
+
+int ContractionHierarchy::shortcutCount() const {
+    return numShortcuts;
+}
+
+/*
+ * Contracts the nodes in order of a lazily updated priority: the edge difference (shortcuts
+ * the contraction would add minus the edges it would remove) plus the number of neighbors
+ * already contracted, which spreads the contraction evenly over the map.  When the front
+ * node's recomputed priority is worse than the next one's, it is put back instead.
+ */
+void ContractionHierarchy::contractAll() {
+
+    int numNodes = graph.nodeCount();
+    LinkLists outLinks(numNodes);
+    LinkLists inLinks(numNodes);
+    vector<bool> contracted(numNodes, false);
+    vector<int> contractedNeighbors(numNodes, 0);
+    vector<int> nodeRanks(numNodes, 0);
+    vector<Arc> allArcs;
+    WitnessSearch witness(numNodes);
+
+    // Adds the arc from u to w unless an equally cheap one is already present
+    auto connect = [&](int u, int w, double cost, int first, int second) {
+        Link* existing = findLink(outLinks[u], w);
+        if (existing != nullptr and existing->cost <= cost) {
+            return;
+        }
+
+        int arcId = allArcs.size();
+        allArcs.push_back({u, w, cost, first, second});
+        if (existing != nullptr) {
+            existing->cost = cost;
+            existing->arc = arcId;
+            Link* reverse = findLink(inLinks[w], u);
+            reverse->cost = cost;
+            reverse->arc = arcId;
+        }
+        else {
+            outLinks[u].push_back({w, cost, arcId});
+            inLinks[w].push_back({u, cost, arcId});
+        }
+    };
+
+    // Counts (and if addShortcuts is set, adds) the shortcuts needed to contract v
+    auto shortcutsFor = [&](int v, bool addShortcuts) {
+        int count = 0;
+        for (const Link& in : inLinks[v]) {
+
+            double maxCost = 0.0;
+            for (const Link& out : outLinks[v]) {
+                maxCost = max(maxCost, in.cost + out.cost);
+            }
+            witness.run(outLinks, contracted, in.node, v, maxCost);
+
+            for (const Link& out : outLinks[v]) {
+                double viaCost = in.cost + out.cost;
+                if (out.node != in.node and witness.distanceTo(out.node) > viaCost) {
+                    count++;
+                    if (addShortcuts) {
+                        connect(in.node, out.node, viaCost, in.arc, out.arc);
+                    }
+                }
+            }
+        }
+        return count;
+    };
+
+    auto priorityOf = [&](int v) {
+        int edgeDifference = shortcutsFor(v, false) - (int) inLinks[v].size() - (int) outLinks[v].size();
+        return (double) edgeDifference + contractedNeighbors[v];
+    };
+
+    // The original edges (without self loops) are the starting arcs
+    for (int v = 0; v < numNodes; v++) {
+        for (int edge = graph.firstEdge(v); edge < graph.endEdge(v); edge++) {
+            int w = graph.edgeTarget(edge);
+            if (w != v) {
+                connect(v, w, graph.edgeCost(edge), NO_ARC, NO_ARC);
+            }
+        }
+    }
+    int numOriginalArcs = allArcs.size();
+
+    using Entry = pair<double, int>;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> order;
+    for (int v = 0; v < numNodes; v++) {
+        order.push({priorityOf(v), v});
+    }
+
+    vector<vector<Link>> upLinks(numNodes);
+    vector<vector<Link>> downLinks(numNodes);
+    int nextRank = 0;
+
+    while (!order.empty()) {
+
+        int v = order.top().second;
+        order.pop();
+
+        double priority = priorityOf(v);
+        if (!order.empty() and priority > order.top().first) {
+            order.push({priority, v});
+            continue;
+        }
+
+        // Every remaining neighbor will be contracted later, so it has a higher rank
+        upLinks[v] = outLinks[v];
+        downLinks[v] = inLinks[v];
+
+        shortcutsFor(v, true);
+        contracted[v] = true;
+        nodeRanks[v] = nextRank++;
+
+        for (const Link& in : inLinks[v]) {
+            removeLink(outLinks[in.node], v);
+            contractedNeighbors[in.node]++;
+        }
+        for (const Link& out : outLinks[v]) {
+            removeLink(inLinks[out.node], v);
+            contractedNeighbors[out.node]++;
+        }
+        vector<Link>().swap(outLinks[v]);
+        vector<Link>().swap(inLinks[v]);
+    }
+
+    numShortcuts = allArcs.size() - numOriginalArcs;
+    ranks = FlatArray<int>(move(nodeRanks));
+    arcs = FlatArray<Arc>(move(allArcs));
+
+    // Flattening the per-node arc lists into the CSR form used by queries
+    auto flatten = [numNodes](const vector<vector<Link>>& links, ArcList& arcList) {
+        vector<int> offsets(1, 0);
+        vector<int> others;
+        vector<double> costs;
+        vector<int> arcIds;
+        for (int v = 0; v < numNodes; v++) {
+            for (const Link& link : links[v]) {
+                others.push_back(link.node);
+                costs.push_back(link.cost);
+                arcIds.push_back(link.arc);
+            }
+            offsets.push_back(others.size());
+        }
+        arcList.offsets = FlatArray<int>(move(offsets));
+        arcList.others = FlatArray<int>(move(others));
+        arcList.costs = FlatArray<double>(move(costs));
+        arcList.arcIds = FlatArray<int>(move(arcIds));
+    };
+    flatten(upLinks, upward);
+    flatten(downLinks, downward);
+}
+
+void ContractionHierarchy::expandQuery(IndexedHeap& openSet, SearchSpace& space, const SearchSpace& otherSpace,
+                                       const ArcList& arcList, const SearchOptions& options,
+                                       double& bestCost, int& meetId) const {
+
+    int nodeId = openSet.dequeue();
+    space.markVisited(nodeId);
+    reportSettled(graph.nodeAt(nodeId), options);
+    reportRelaxed(arcList.offsets[nodeId + 1] - arcList.offsets[nodeId], options);
+    double currCost = space.distanceTo(nodeId);
+
+    for (int ii = arcList.offsets[nodeId]; ii < arcList.offsets[nodeId + 1]; ii++) {
+
+        int neighborId = arcList.others[ii];
+        if (space.isVisited(neighborId)) {
+            continue;
+        }
+
+        double updatedCost = currCost + arcList.costs[ii];
+        if (updatedCost < space.distanceTo(neighborId)) {
+
+            space.relax(neighborId, nodeId, updatedCost);
+            openSet.enqueueOrDecrease(neighborId, updatedCost);
+            reportFringe(graph.nodeAt(neighborId), options);
+
+            double otherCost = otherSpace.distanceTo(neighborId);
+            if (otherCost != DBL_MAX and updatedCost + otherCost < bestCost) {
+                bestCost = updatedCost + otherCost;
+                meetId = neighborId;
+            }
+        }
+    }
+}
+
+/*
+ * Both directions of the query only climb the hierarchy, so they cannot use the usual
+ * bidirectional stopping rule.  Instead each direction keeps going until its smallest key
+ * is no better than the best meeting point found so far.
+ */
+Path ContractionHierarchy::shortestPath(RoadNode* start, RoadNode* end) const {
+    return shortestPath(start, end, SearchOptions());
+}
+
+Path ContractionHierarchy::shortestPath(RoadNode* start, RoadNode* end, const SearchOptions& options) const {
+
+    SearchTimer timer(options.counters);
+
+    SearchSpace& forwardSpace = SearchSpace::reusable(graph, 0);
+    SearchSpace& backwardSpace = SearchSpace::reusable(graph, 1);
+    IndexedHeap& forwardSet = IndexedHeap::reusable(graph.nodeCount(), options.heapArity, 0);
+    IndexedHeap& backwardSet = IndexedHeap::reusable(graph.nodeCount(), options.heapArity, 1);
+    forwardSet.countInto(options.counters);
+    backwardSet.countInto(options.counters);
+
+    int startId = graph.indexOf(start);
+    int endId = graph.indexOf(end);
+    if (startId == CompactRoadGraph::NO_NODE or endId == CompactRoadGraph::NO_NODE) {
+        error("ContractionHierarchy::shortestPath: the start and end must be part of the graph");
+    }
+    if (startId == endId) {
+        return {start};
+    }
+
+    forwardSpace.relax(startId, SearchSpace::NO_PARENT, 0.0);
+    forwardSet.enqueue(startId, 0.0);
+    backwardSpace.relax(endId, SearchSpace::NO_PARENT, 0.0);
+    backwardSet.enqueue(endId, 0.0);
+
+    double bestCost = DBL_MAX;
+    int meetId = SearchSpace::NO_PARENT;
+
+    while (true) {
+        bool forwardDone = forwardSet.isEmpty() or forwardSet.peekPriority() >= bestCost;
+        bool backwardDone = backwardSet.isEmpty() or backwardSet.peekPriority() >= bestCost;
+        if (forwardDone and backwardDone) {
+            break;
+        }
+
+        if (!forwardDone and (backwardDone or forwardSet.peekPriority() <= backwardSet.peekPriority())) {
+            expandQuery(forwardSet, forwardSpace, backwardSpace, upward, options, bestCost, meetId);
+        }
+        else {
+            expandQuery(backwardSet, backwardSpace, forwardSpace, downward, options, bestCost, meetId);
+        }
+    }
+
+    if (meetId == SearchSpace::NO_PARENT) {
+        return {};
+    }
+
+    // Collecting the forward half of the route, which the predecessor chain lists backward
+    vector<int> forwardNodes;
+    for (int curr = meetId; curr != SearchSpace::NO_PARENT; curr = forwardSpace.parentOf(curr)) {
+        forwardNodes.push_back(curr);
+    }
+    reverse(forwardNodes.begin(), forwardNodes.end());
+
+    Path solnPath;
+    solnPath.add(start);
+    for (size_t ii = 1; ii < forwardNodes.size(); ii++) {
+        unpackArc(findArc(upward, forwardNodes[ii - 1], forwardNodes[ii]), solnPath);
+    }
+
+    // The backward search's predecessors lead from the meeting node to the end
+    for (int curr = meetId; curr != endId; ) {
+        int next = backwardSpace.parentOf(curr);
+        unpackArc(findArc(downward, next, curr), solnPath);
+        curr = next;
+    }
+
+    return solnPath;
+}
+
+void ContractionHierarchy::searchUpward(int rootId, const ArcList& arcList, const SearchOptions& options,
+                                        vector<pair<int, double>>& settled) const {
+
+    SearchSpace& space = SearchSpace::reusable(graph);
+    IndexedHeap& openSet = IndexedHeap::reusable(graph.nodeCount(), options.heapArity);
+    openSet.countInto(options.counters);
+    space.relax(rootId, SearchSpace::NO_PARENT, 0.0);
+    openSet.enqueue(rootId, 0.0);
+
+    while (!openSet.isEmpty()) {
+
+        int nodeId = openSet.dequeue();
+        space.markVisited(nodeId);
+        reportSettled(graph.nodeAt(nodeId), options);
+        reportRelaxed(arcList.offsets[nodeId + 1] - arcList.offsets[nodeId], options);
+        double currCost = space.distanceTo(nodeId);
+        settled.push_back({nodeId, currCost});
+
+        for (int ii = arcList.offsets[nodeId]; ii < arcList.offsets[nodeId + 1]; ii++) {
+            int neighborId = arcList.others[ii];
+            double updatedCost = currCost + arcList.costs[ii];
+            if (!space.isVisited(neighborId) and updatedCost < space.distanceTo(neighborId)) {
+                space.relax(neighborId, nodeId, updatedCost);
+                openSet.enqueueOrDecrease(neighborId, updatedCost);
+                reportFringe(graph.nodeAt(neighborId), options);
+            }
+        }
+    }
+}
+
+/*
+ * The bucket method.  Every shortest path climbs the hierarchy from the source to its
+ * highest node and then descends to the target, so its cost is the smallest sum, over
+ * the nodes v reached by both, of an upward search from the source to v and a backward
+ * upward search from the target to v.  One backward search per target leaves an entry
+ * (target, distance) in the bucket of every node it settles; then one forward search per
+ * source only has to scan the buckets of the nodes it settles.  Both kinds of search are
+ * small, so this costs N + M tiny searches instead of N x M point-to-point queries.
+ */
+Grid<double> ContractionHierarchy::distanceMatrix(const Vector<RoadNode*>& sources,
+                                                  const Vector<RoadNode*>& targets,
+                                                  const SearchOptions& options) const {
+
+    SearchTimer timer(options.counters);
+    int numNodes = graph.nodeCount();
+    Grid<double> matrix(sources.size(), targets.size(), DBL_MAX);
+
+    // Filling the buckets from the backward searches, then grouping them by node
+    struct BucketEntry {
+        int node;
+        int target;
+        double distance;
+    };
+    vector<BucketEntry> entries;
+    vector<pair<int, double>> settled;
+    for (int jj = 0; jj < targets.size(); jj++) {
+        int targetId = graph.indexOf(targets[jj]);
+        if (targetId == CompactRoadGraph::NO_NODE) {
+            error("ContractionHierarchy::distanceMatrix: a target is not part of the graph");
+        }
+        settled.clear();
+        searchUpward(targetId, downward, options, settled);
+        for (const pair<int, double>& entry : settled) {
+            entries.push_back({entry.first, jj, entry.second});
+        }
+    }
+
+    vector<int> bucketOffsets(numNodes + 1, 0);
+    for (const BucketEntry& entry : entries) {
+        bucketOffsets[entry.node + 1]++;
+    }
+    for (int node = 0; node < numNodes; node++) {
+        bucketOffsets[node + 1] += bucketOffsets[node];
+    }
+    vector<pair<int, double>> buckets(entries.size());
+    vector<int> nextSlot(bucketOffsets.begin(), bucketOffsets.end() - 1);
+    for (const BucketEntry& entry : entries) {
+        buckets[nextSlot[entry.node]++] = {entry.target, entry.distance};
+    }
+
+    // Scanning the buckets from the forward searches
+    for (int ii = 0; ii < sources.size(); ii++) {
+        int sourceId = graph.indexOf(sources[ii]);
+        if (sourceId == CompactRoadGraph::NO_NODE) {
+            error("ContractionHierarchy::distanceMatrix: a source is not part of the graph");
+        }
+        settled.clear();
+        searchUpward(sourceId, upward, options, settled);
+        for (const pair<int, double>& entry : settled) {
+            for (int slot = bucketOffsets[entry.first]; slot < bucketOffsets[entry.first + 1]; slot++) {
+                double distance = entry.second + buckets[slot].second;
+                if (distance < matrix[ii][buckets[slot].first]) {
+                    matrix[ii][buckets[slot].first] = distance;
+                }
+            }
+        }
+    }
+
+    return matrix;
+}
+
+int ContractionHierarchy::findArc(const ArcList& arcList, int node, int other) const {
+    for (int ii = arcList.offsets[node]; ii < arcList.offsets[node + 1]; ii++) {
+        if (arcList.others[ii] == other) {
+            return arcList.arcIds[ii];
+        }
+    }
+    return NO_ARC;
+}
+
+void ContractionHierarchy::unpackArc(int arcId, Path& path) const {
+    const Arc& arc = arcs[arcId];
+    if (arc.first == NO_ARC) {
+        path.add(graph.nodeAt(arc.to));
+    }
+    else {
+        unpackArc(arc.first, path);
+        unpackArc(arc.second, path);
+    }
+}
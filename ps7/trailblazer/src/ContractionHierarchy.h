@@ -0,0 +1,150 @@
+/*
+ * This header declares the ContractionHierarchy class, a preprocessed form of a RoadGraph
+ * that answers point-to-point shortest path queries far faster than A*.
+ *
+ * Preprocessing contracts the nodes one at a time, least important first.  Contracting a
+ * node removes it from the remaining graph and, for every pair of remaining neighbors
+ * whose only shortest connection ran through it, adds a "shortcut" edge with the cost of
+ * that two-edge route.  The order in which nodes are contracted is their rank.
+ *
+ * A query then runs a bidirectional Dijkstra search in which both directions only ever
+ * move to higher-ranked nodes, which keeps both searches tiny.  Shortcuts on the route
+ * found are unpacked recursively into the original edges, so the result is an ordinary
+ * Path over the RoadGraph.
+ *
+ * The hierarchy is built from the graph's CSR snapshot, and it must be rebuilt if edges
+ * are added to the graph or their costs change.  Since building it is slow on large
+ * maps, it can be kept on disk in a RoutingIndex.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "grid.h"
+#include "vector.h"
+#include "CompactRoadGraph.h"
+#include "FlatArray.h"
+#include "IndexedHeap.h"
+#include "RoadGraph.h"
+#include "SearchOptions.h"
+#include "SearchSpace.h"
+#include "Trailblazer.h"
+
+class ContractionHierarchy {
+public:
+    /*
+     * Runs the contraction preprocessing over the given graph.
+     */
+    explicit ContractionHierarchy(const RoadGraph& graph);
+
+    /*
+     * Returns a shortest path from start to end, or an empty path if there is none.
+     * Nodes settled by the query are colored as in the other searches.
+     */
+    Path shortestPath(RoadNode* start, RoadNode* end) const;
+
+    /*
+     * Variant of shortestPath() that takes extra settings (see SearchOptions.h).  The
+     * landmarks setting does not apply to the hierarchy and is ignored.
+     */
+    Path shortestPath(RoadNode* start, RoadNode* end, const SearchOptions& options) const;
+
+    /*
+     * Returns the cost of the cheapest path from every source to every target, with the
+     * sources as rows and the targets as columns, like distanceMatrix() in
+     * ShortestPathTree.h.  Unreachable pairs hold DBL_MAX.
+     */
+    Grid<double> distanceMatrix(const Vector<RoadNode*>& sources, const Vector<RoadNode*>& targets,
+                                const SearchOptions& options = SearchOptions()) const;
+
+    /*
+     * Returns the CSR snapshot whose dense node IDs the hierarchy uses.
+     */
+    const CompactRoadGraph& compactGraph() const;
+
+    /*
+     * Returns the rank (contraction order) of the node with the given dense ID.
+     */
+    int rankOf(int node) const;
+
+    /*
+     * Returns the number of shortcut edges added by the preprocessing.
+     */
+    int shortcutCount() const;
+
+private:
+    /* Value stored in an arc's children when it is an original edge, not a shortcut. */
+    static const int NO_ARC = -1;
+
+    /*
+     * An edge of the hierarchy: either an original edge of the graph, or a shortcut that
+     * stands for the two arcs first and second, in that order.
+     */
+    struct Arc {
+        int from;
+        int to;
+        double cost;
+        int first;
+        int second;
+    };
+
+    /*
+     * The arcs that a query may follow from a node, in CSR form: upward arcs for the
+     * forward search are grouped by their source, and the arcs used by the backward
+     * search are grouped by their target (and lead to a higher-ranked source).
+     */
+    struct ArcList {
+        FlatArray<int> offsets;     // nodeCount() + 1 entries
+        FlatArray<int> others;      // node at the far end of the arc
+        FlatArray<double> costs;    // cost of the arc
+        FlatArray<int> arcIds;      // index into arcs
+    };
+
+    const CompactRoadGraph& graph;
+    FlatArray<int> ranks;            // dense ID -> contraction order
+    FlatArray<Arc> arcs;             // every original edge and shortcut
+    int numShortcuts;
+    ArcList upward;                  // forward search arcs, grouped by source
+    ArcList downward;                // backward search arcs, grouped by target
+
+    /* A RoutingIndex fills in the tables of the hierarchies it loads. */
+    friend class RoutingIndex;
+
+    /*
+     * Constructs a hierarchy over the given snapshot with empty tables, for a
+     * RoutingIndex to fill in.
+     */
+    explicit ContractionHierarchy(const CompactRoadGraph& graph);
+
+    /*
+     * Contracts every node of the graph, filling in ranks, arcs, upward and downward.
+     */
+    void contractAll();
+
+    /*
+     * Runs one direction of the query: settles the front node of the open set and relaxes
+     * its arcs, updating the best meeting point found so far.
+     */
+    void expandQuery(IndexedHeap& openSet, SearchSpace& space, const SearchSpace& otherSpace,
+                     const ArcList& arcList, const SearchOptions& options,
+                     double& bestCost, int& meetId) const;
+
+    /*
+     * Runs an upward Dijkstra search from rootId over the given arcs until it runs out of
+     * nodes, and appends every node it settles to settled along with its distance.
+     */
+    void searchUpward(int rootId, const ArcList& arcList, const SearchOptions& options,
+                      std::vector<std::pair<int, double>>& settled) const;
+
+    /*
+     * Returns the index of the arc listed between node and other in the given list.
+     */
+    int findArc(const ArcList& arcList, int node, int other) const;
+
+    /*
+     * Appends the nodes that the given arc passes through to the path, excluding the
+     * node it starts from, by recursively unpacking shortcuts.
+     */
+    void unpackArc(int arcId, Path& path) const;
+};
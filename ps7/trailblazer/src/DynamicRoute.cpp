@@ -0,0 +1,386 @@
+/*
+ * This sourcecode file implements the DynamicRoute class declared in DynamicRoute.h.
+ */
+
+#include <algorithm>
+#include <cfloat>
+
+#include "error.h"
+#include "DynamicRoute.h"
+#include "Landmarks.h"
+using namespace std;
+
+/* Private constants only needed in this file. */
+namespace {
+    /* The queue is rebuilt once its stale entries outnumber the live ones by this much. */
+    const int MAX_STALE_ENTRIES = 64;
+
+    /* Relative difference below which two keys count as tied on their first component. */
+    const double KEY_TOLERANCE = 1e-9;
+
+    /* The heap algorithms build max-heaps, so the comparison is reversed. */
+    struct LaterEntry {
+        template <typename Entry>
+        bool operator ()(const Entry& a, const Entry& b) const {
+            return b.key < a.key;
+        }
+    };
+}
+
+const int DynamicRoute::NO_PARENT;
+
+bool DynamicRoute::Key::operator <(const Key& other) const {
+    return primary < other.primary or (primary == other.primary and secondary < other.secondary);
+}
+
+DynamicRoute::DynamicRoute(RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options)
+    : graph(graph),
+      compact(graph.compact()),
+      options(options),
+      startId(compact.indexOf(start)),
+      endId(compact.indexOf(end)),
+      speed(graph.maxRoadSpeed()),
+      numQueued(0) {
+
+    if (startId == CompactRoadGraph::NO_NODE or endId == CompactRoadGraph::NO_NODE) {
+        error("DynamicRoute: the start and end must be part of the graph");
+    }
+    if (options.landmarks != nullptr and &options.landmarks->compactGraph() != &compact) {
+        error("DynamicRoute: the landmark tables were not built for this graph");
+    }
+
+    computePotentials();
+    if (options.landmarks != nullptr) {
+        landmarkCosts.resize(compact.edgeCount());
+        for (int edge = 0; edge < compact.edgeCount(); edge++) {
+            landmarkCosts[edge] = compact.edgeCost(edge);
+        }
+    }
+
+    int numNodes = compact.nodeCount();
+    g.assign(numNodes, DBL_MAX);
+    rhs.assign(numNodes, DBL_MAX);
+    parent.assign(numNodes, NO_PARENT);
+    queueState.assign(numNodes, NOT_QUEUED);
+    queuedKey.resize(numNodes);
+
+    rhs[startId] = 0.0;
+    updateNode(startId);
+}
+
+RoadNode* DynamicRoute::start() const {
+    return compact.nodeAt(startId);
+}
+
+RoadNode* DynamicRoute::end() const {
+    return compact.nodeAt(endId);
+}
+
+/*
+ * Every node's parent is the predecessor its rhs value came from, so once the end node is
+ * consistent the parents lead back to the start along a shortest path.
+ */
+Path DynamicRoute::path() {
+
+    computeShortestPath();
+    if (g[endId] == DBL_MAX) {
+        return {};
+    }
+
+    Path reversed;
+    for (int curr = endId; curr != startId; curr = parent[curr]) {
+        if (curr == NO_PARENT or reversed.size() > compact.nodeCount()) {
+            error("DynamicRoute: the predecessor chain does not lead back to the start");
+        }
+        reversed.add(compact.nodeAt(curr));
+    }
+    reversed.add(compact.nodeAt(startId));
+
+    Path result;
+    for (int ii = reversed.size() - 1; ii >= 0; ii--) {
+        result.add(reversed[ii]);
+    }
+    return result;
+}
+
+double DynamicRoute::cost() {
+    computeShortestPath();
+    return g[endId];
+}
+
+void DynamicRoute::setEdgeCost(RoadEdge* edge, double cost) {
+    int edgeId = compact.edgeIndexOf(edge);
+    if (edgeId != CompactRoadGraph::NO_EDGE) {
+        checkLandmarkCost(edgeId, cost);
+    }
+    graph.setEdgeCost(edge, cost);
+    edgeCostChanged(edge);
+}
+
+/*
+ * Only the node the edge enters can have a different rhs value.  A cheaper edge may make
+ * it the node's best way in; a more expensive one matters only if it already was.
+ */
+void DynamicRoute::edgeCostChanged(RoadEdge* edge) {
+
+    int edgeId = compact.edgeIndexOf(edge);
+    if (edgeId == CompactRoadGraph::NO_EDGE) {
+        error("DynamicRoute: the edge is not part of the graph");
+    }
+    checkLandmarkCost(edgeId, compact.edgeCost(edgeId));
+
+    // A faster road lowers the crow-fly bound everywhere, which changes every key
+    if (options.landmarks == nullptr and graph.maxRoadSpeed() > speed) {
+        speed = graph.maxRoadSpeed();
+        computePotentials();
+        rebuildQueue();
+    }
+
+    int from = compact.indexOf(edge->from());
+    int to = compact.edgeTarget(edgeId);
+    if (to == startId) {
+        return;
+    }
+
+    double throughEdge = g[from] == DBL_MAX ? DBL_MAX : g[from] + compact.edgeCost(edgeId);
+    if (throughEdge < rhs[to]) {
+        rhs[to] = throughEdge;
+        parent[to] = from;
+        updateNode(to);
+    }
+    else if (parent[to] == from) {
+        recomputeRhs(to);
+        updateNode(to);
+    }
+}
+
+/*
+ * The end node never changes, so the heuristic of every node is computed once, in bulk,
+ * and every key computed afterwards only reads it.
+ */
+void DynamicRoute::computePotentials() {
+
+    if (options.landmarks != nullptr) {
+        potentials.resize(compact.nodeCount());
+        for (int node = 0; node < compact.nodeCount(); node++) {
+            potentials[node] = options.landmarks->lowerBound(node, endId);
+        }
+        return;
+    }
+
+    compact.crowFlyDistancesTo(endId, potentials);
+    for (double& potential : potentials) {
+        potential /= speed;
+    }
+}
+
+void DynamicRoute::checkLandmarkCost(int edge, double cost) const {
+    if (options.landmarks != nullptr and cost < landmarkCosts[edge]) {
+        error("DynamicRoute: with landmarks, edge costs cannot drop below their cost when the route was made");
+    }
+}
+
+double DynamicRoute::heuristic(int node) const {
+    return potentials[node];
+}
+
+DynamicRoute::Key DynamicRoute::calculateKey(int node) const {
+    double best = min(g[node], rhs[node]);
+    if (best == DBL_MAX) {
+        return {DBL_MAX, DBL_MAX};
+    }
+    return {best + heuristic(node), best};
+}
+
+void DynamicRoute::updateNode(int node) {
+
+    if (g[node] == rhs[node]) {
+        if (queueState[node] == QUEUED) {
+            queueState[node] = NOT_QUEUED;
+            numQueued--;
+        }
+        return;
+    }
+
+    Key key = calculateKey(node);
+    if (queueState[node] == QUEUED and !(key < queuedKey[node]) and !(queuedKey[node] < key)) {
+        return;
+    }
+    if (queueState[node] == NOT_QUEUED) {
+        queueState[node] = QUEUED;
+        numQueued++;
+        reportFringe(compact.nodeAt(node), options);
+    }
+    queuedKey[node] = key;
+    queue.push_back({key, node});
+    push_heap(queue.begin(), queue.end(), LaterEntry());
+    if (options.counters != nullptr) {
+        options.counters->pushes++;
+        options.counters->peakOpenSet = max(options.counters->peakOpenSet, (long long) numQueued);
+    }
+
+    if ((int) queue.size() > 2 * numQueued + MAX_STALE_ENTRIES) {
+        rebuildQueue();
+    }
+}
+
+void DynamicRoute::recomputeRhs(int node) {
+
+    double best = DBL_MAX;
+    int bestParent = NO_PARENT;
+    for (int inEdge = compact.firstInEdge(node); inEdge < compact.endInEdge(node); inEdge++) {
+        int source = compact.inEdgeSource(inEdge);
+        if (g[source] != DBL_MAX and g[source] + compact.inEdgeCost(inEdge) < best) {
+            best = g[source] + compact.inEdgeCost(inEdge);
+            bestParent = source;
+        }
+    }
+    rhs[node] = best;
+    parent[node] = bestParent;
+}
+
+/*
+ * An entry is stale if its node has left the queue or has been queued again with another
+ * key since it was pushed.
+ */
+DynamicRoute::Key DynamicRoute::topKey() {
+
+    while (!queue.empty()) {
+        const QueueEntry& front = queue.front();
+        bool stale = queueState[front.node] == NOT_QUEUED or front.key < queuedKey[front.node] or queuedKey[front.node] < front.key;
+        if (!stale) {
+            return front.key;
+        }
+        pop_heap(queue.begin(), queue.end(), LaterEntry());
+        queue.pop_back();
+    }
+    return {DBL_MAX, DBL_MAX};
+}
+
+/*
+ * A node can have several live-looking entries if it went back to an earlier key, so the
+ * rebuild keeps only the first entry of each queued node, marking the nodes it has kept.
+ */
+void DynamicRoute::rebuildQueue() {
+
+    vector<QueueEntry> live;
+    live.reserve(numQueued);
+    for (const QueueEntry& entry : queue) {
+        if (queueState[entry.node] == QUEUED) {
+            queueState[entry.node] = KEPT;
+            queuedKey[entry.node] = calculateKey(entry.node);
+            live.push_back({queuedKey[entry.node], entry.node});
+        }
+    }
+    for (const QueueEntry& entry : live) {
+        queueState[entry.node] = QUEUED;
+    }
+
+    queue.swap(live);
+    make_heap(queue.begin(), queue.end(), LaterEntry());
+}
+
+/*
+ * The search may stop once the end node is consistent and no queued node comes before it
+ * (or once the queue is empty).
+ * A tight heuristic gives many nodes on the route the same first key component as the end
+ * node, but rounding can place them a hair after it; stopping there would leave those
+ * nodes unprocessed and the route wrong.  So first components that agree to within a
+ * rounding error count as tied, and the second component decides.  Finally the route
+ * itself must be consistent.
+ */
+bool DynamicRoute::endIsSettled() {
+
+    Key top = topKey();
+    if (top.primary == DBL_MAX) {
+        return true;
+    }
+    if (g[endId] != rhs[endId]) {
+        return false;
+    }
+
+    Key endKey = calculateKey(endId);
+    double tolerance = KEY_TOLERANCE * max(1.0, endKey.primary);
+    if (top.primary < endKey.primary - tolerance) {
+        return false;
+    }
+    if (top.primary < endKey.primary + tolerance and top.secondary < endKey.secondary) {
+        return false;
+    }
+    return routeIsConsistent();
+}
+
+/*
+ * Every rhs value is the g value of the node's parent plus the cost of the edge between
+ * them, so if every node on the route is consistent, the end node's g value is exactly
+ * the cost of the route.  An inconsistent heuristic (the crow-fly bound is not quite
+ * consistent, and landmark bounds lose precision on huge costs) can end the search while
+ * the route still runs through a node whose g value is out of date; checking the route
+ * keeps the search going until it has dealt with that node, so the cost reported is
+ * always that of a real path.
+ */
+bool DynamicRoute::routeIsConsistent() const {
+
+    if (g[endId] == DBL_MAX) {
+        return true;
+    }
+    int steps = 0;
+    for (int curr = endId; curr != startId; curr = parent[curr]) {
+        if (curr == NO_PARENT or g[curr] != rhs[curr] or ++steps > compact.nodeCount()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * The main loop of LPA*.  An overconsistent node (g > rhs) has found a cheaper path, so it
+ * takes on its rhs value and offers it to its successors.  An underconsistent node (g < rhs)
+ * has lost the path it had, so its g value is reset and every successor that depended on
+ * it looks for a new best predecessor; the node itself is queued again if it still has one.
+ */
+void DynamicRoute::computeShortestPath() {
+
+    SearchTimer timer(options.counters);
+
+    while (!endIsSettled()) {
+
+        // endIsSettled() has dropped any stale entries from the front of the queue
+        int nodeId = queue.front().node;
+        pop_heap(queue.begin(), queue.end(), LaterEntry());
+        queue.pop_back();
+        queueState[nodeId] = NOT_QUEUED;
+        numQueued--;
+        if (options.counters != nullptr) {
+            options.counters->pops++;
+        }
+        reportRelaxed(compact.endEdge(nodeId) - compact.firstEdge(nodeId), options);
+
+        if (g[nodeId] > rhs[nodeId]) {
+            g[nodeId] = rhs[nodeId];
+            reportSettled(compact.nodeAt(nodeId), options);
+
+            for (int edge = compact.firstEdge(nodeId); edge < compact.endEdge(nodeId); edge++) {
+                int neighborId = compact.edgeTarget(edge);
+                double updatedCost = g[nodeId] + compact.edgeCost(edge);
+                if (neighborId != startId and updatedCost < rhs[neighborId]) {
+                    rhs[neighborId] = updatedCost;
+                    parent[neighborId] = nodeId;
+                    updateNode(neighborId);
+                }
+            }
+        }
+        else {
+            g[nodeId] = DBL_MAX;
+            updateNode(nodeId);
+
+            for (int edge = compact.firstEdge(nodeId); edge < compact.endEdge(nodeId); edge++) {
+                int neighborId = compact.edgeTarget(edge);
+                if (neighborId != startId and parent[neighborId] == nodeId) {
+                    recomputeRhs(neighborId);
+                    updateNode(neighborId);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ * This header declares the DynamicRoute class, which keeps the shortest path between one
+ * fixed start and end up to date while edge costs change, e.g. with live traffic.
+ *
+ * Rerunning A* after every change throws away all of the previous search.  DynamicRoute
+ * uses Lifelong Planning A* (LPA*) instead: it keeps, for every node it has touched, the
+ * cost g of the best path found so far and a one-step lookahead rhs computed from the g
+ * values of the node's predecessors.  A node whose two values differ is "inconsistent" and
+ * sits in the priority queue.  Changing an edge only recomputes the rhs value of the node
+ * it enters, and the next query processes the inconsistent nodes in A* order until the
+ * end node is consistent and nothing cheaper is left in the queue.  A change far away
+ * from the route costs almost nothing, and one on the route only redoes the part of the
+ * search that it affects.
+ *
+ * The heuristic is the one aStar() uses: the landmark bound if options.landmarks is set,
+ * and otherwise the crow-fly time at the top speed on the map.  Landmark tables are built
+ * for the costs at that time, so they only stay valid lower bounds while costs do not drop
+ * below those: with landmarks, lowering an edge below its cost when the route was made is
+ * reported as an error.  The crow-fly bound follows speed increases automatically.
+ */
+
+#pragma once
+
+#include <vector>
+#include "CompactRoadGraph.h"
+#include "RoadGraph.h"
+#include "SearchOptions.h"
+#include "Trailblazer.h"
+
+class DynamicRoute {
+public:
+    /*
+     * Prepares to route from start to end.  No search runs until the route is asked for.
+     * The options (including any landmarks and counters they point to) are used by every
+     * later repair.
+     */
+    DynamicRoute(RoadGraph& graph, RoadNode* start, RoadNode* end,
+                 const SearchOptions& options = SearchOptions());
+
+    /*
+     * Returns the start / end node of the route.
+     */
+    RoadNode* start() const;
+    RoadNode* end() const;
+
+    /*
+     * Returns the current shortest path from start to end (empty if there is none), first
+     * repairing the search after any edge changes since the last call.
+     */
+    Path path();
+
+    /*
+     * Returns the cost of the current shortest path, or DBL_MAX if there is none, repairing
+     * the search first like path().
+     */
+    double cost();
+
+    /*
+     * Changes the cost of an edge in the graph (see RoadGraph::setEdgeCost()) and records
+     * the change for the next repair.  With landmarks, reports an error, leaving the graph
+     * unchanged, if the cost is below the edge's cost when the route was made.
+     */
+    void setEdgeCost(RoadEdge* edge, double cost);
+
+    /*
+     * Records that the cost of an edge was changed directly through the graph, e.g. when
+     * several routes share a graph and only one of them made the change.  With landmarks,
+     * reports an error if the new cost is below the edge's cost when the route was made.
+     */
+    void edgeCostChanged(RoadEdge* edge);
+
+private:
+    /* Value stored as the parent of nodes that have none. */
+    static const int NO_PARENT = -1;
+
+    /* LPA* orders nodes by the pair (min(g, rhs) + h, min(g, rhs)), lexicographically. */
+    struct Key {
+        double primary;
+        double secondary;
+        bool operator <(const Key& other) const;
+    };
+
+    /* One queue entry.  Entries are not removed when a node leaves the queue or changes
+     * key; they become stale instead and are skipped when they reach the front.
+     */
+    struct QueueEntry {
+        Key key;
+        int node;
+    };
+
+    /* Whether a node is in the queue.  KEPT marks queued nodes whose entry rebuildQueue()
+     * has already kept, and is only used while it runs.
+     */
+    enum QueueState : char {
+        NOT_QUEUED,
+        QUEUED,
+        KEPT
+    };
+
+    RoadGraph& graph;
+    const CompactRoadGraph& compact;
+    SearchOptions options;
+    int startId;
+    int endId;
+    double speed;                        // the top speed the crow-fly heuristic divides by
+
+    std::vector<double> potentials;      // node -> heuristic estimate of its cost to the end
+    std::vector<double> landmarkCosts;   // edge -> its cost when the route was made (landmarks only)
+    std::vector<double> g;               // node -> cost of the best path found to it
+    std::vector<double> rhs;             // node -> best cost through its predecessors' g
+    std::vector<int> parent;             // node -> predecessor that rhs was taken from
+    std::vector<QueueState> queueState;  // node -> whether the node is in the queue
+    std::vector<Key> queuedKey;          // node -> its key in the queue, if queued
+    std::vector<QueueEntry> queue;       // binary min-heap of entries, with stale ones
+    int numQueued;
+
+    /*
+     * Computes the heuristic estimate of the cost to the end for every node at once.
+     */
+    void computePotentials();
+
+    /*
+     * Reports an error if the landmark bounds would not stay valid with the edge at the
+     * given cost.
+     */
+    void checkLandmarkCost(int edge, double cost) const;
+
+    /*
+     * Returns the heuristic estimate of the cost from the node to the end.
+     */
+    double heuristic(int node) const;
+
+    /*
+     * Returns the queue key of the node for its current g and rhs values.
+     */
+    Key calculateKey(int node) const;
+
+    /*
+     * Puts the node in the queue with its current key if it is inconsistent, and takes it
+     * out otherwise.
+     */
+    void updateNode(int node);
+
+    /*
+     * Recomputes rhs and parent of the node from all of its predecessors.
+     */
+    void recomputeRhs(int node);
+
+    /*
+     * Returns the key at the front of the queue, dropping stale entries on the way.
+     */
+    Key topKey();
+
+    /*
+     * Rebuilds the heap from the valid entries only, with freshly computed keys.
+     */
+    void rebuildQueue();
+
+    /*
+     * Returns whether the shortest path to the end is known, i.e. whether the search can
+     * stop.
+     */
+    bool endIsSettled();
+
+    /*
+     * Returns whether every node on the route, as given by the parents, is consistent.
+     */
+    bool routeIsConsistent() const;
+
+    /*
+     * Processes inconsistent nodes until the shortest path to the end is known.
+     */
+    void computeShortestPath();
+};
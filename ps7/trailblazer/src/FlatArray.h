@@ -0,0 +1,124 @@
+/*
+ * This header declares and implements the FlatArray class template, a read-only array
+ * that either owns its elements or views elements stored somewhere else, such as inside
+ * a memory-mapped file (see MappedFile.h).  The preprocessing classes keep their tables
+ * in FlatArrays, so the same lookup code runs whether the tables were just computed or
+ * were loaded in place from a RoutingIndex file without being copied.
+ *
+ * A viewing FlatArray does not keep the memory it views alive; whoever creates the view
+ * must make sure that memory outlives it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename ValueType>
+class FlatArray {
+public:
+    /*
+     * Constructs an empty array.
+     */
+    FlatArray();
+
+    /*
+     * Constructs an array that takes over the elements of the given vector.
+     */
+    explicit FlatArray(std::vector<ValueType>&& elements);
+
+    /*
+     * Returns an array that views the given number of elements starting at the given
+     * address, without copying them.
+     */
+    static FlatArray view(const ValueType* elements, size_t length);
+
+    /*
+     * Returns the element at the given index, which is not bounds-checked.
+     */
+    const ValueType& operator[](size_t index) const;
+
+    /*
+     * Returns the number of elements, and whether there are none.
+     */
+    size_t size() const;
+    bool empty() const;
+
+    /*
+     * Returns the address of the first element, and the bounds used by range-based for loops.
+     */
+    const ValueType* data() const;
+    const ValueType* begin() const;
+    const ValueType* end() const;
+
+    /* Moving keeps the owned vector's buffer, so the element pointer stays valid; a copy
+     * would have to repoint it, and no caller needs one.
+     */
+    FlatArray(FlatArray&& other) = default;
+    FlatArray& operator=(FlatArray&& other) = default;
+    FlatArray(const FlatArray&) = delete;
+    FlatArray& operator=(const FlatArray&) = delete;
+
+private:
+    std::vector<ValueType> owned;   // the elements, unless the array is a view
+    const ValueType* elements;      // the first element, in owned or elsewhere
+    size_t length;
+};
+
+template <typename ValueType>
+FlatArray<ValueType>::FlatArray()
+    : elements(nullptr),
+      length(0) {
+    // Everything else handled by default
+}
+
+template <typename ValueType>
+FlatArray<ValueType>::FlatArray(std::vector<ValueType>&& elements)
+    : owned(std::move(elements)),
+      elements(owned.data()),
+      length(owned.size()) {
+    // Everything else handled by default
+}
+
+template <typename ValueType>
+FlatArray<ValueType> FlatArray<ValueType>::view(const ValueType* elements, size_t length) {
+    FlatArray array;
+    array.elements = elements;
+    array.length = length;
+    return array;
+}
+
+/*
+ * The element accessor is called once per relaxed edge, so it is defined here (like the
+ * rest of the template) where the compiler can inline it.
+ */
+template <typename ValueType>
+inline const ValueType& FlatArray<ValueType>::operator[](size_t index) const {
+    return elements[index];
+}
+
+template <typename ValueType>
+inline size_t FlatArray<ValueType>::size() const {
+    return length;
+}
+
+template <typename ValueType>
+inline bool FlatArray<ValueType>::empty() const {
+    return length == 0;
+}
+
+template <typename ValueType>
+inline const ValueType* FlatArray<ValueType>::data() const {
+    return elements;
+}
+
+template <typename ValueType>
+inline const ValueType* FlatArray<ValueType>::begin() const {
+    return elements;
+}
+
+template <typename ValueType>
+inline const ValueType* FlatArray<ValueType>::end() const {
+    return elements + length;
+}
@@ -0,0 +1,198 @@
+/*
+ * This sourcecode file implements the IndexedHeap class declared in IndexedHeap.h.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include "error.h"
+#include "IndexedHeap.h"
+#include "SearchCounters.h"
+using namespace std;
+
+/* Number of reusable heaps kept per thread. */
+static const int NUM_REUSABLE_SLOTS = 4;
+
+IndexedHeap::IndexedHeap(int capacity, int arity)
+    : d(arity),
+      positions(capacity, NOT_IN_HEAP),
+      counters(nullptr) {
+
+    if (arity < 2) {
+        error("IndexedHeap: arity must be at least 2");
+    }
+}
+
+IndexedHeap& IndexedHeap::reusable(int capacity, int arity, int slot) {
+
+    static thread_local unique_ptr<IndexedHeap> heaps[NUM_REUSABLE_SLOTS];
+    unique_ptr<IndexedHeap>& heap = heaps[slot];
+
+    if (!heap or heap->capacity() != capacity or heap->arity() != arity) {
+        heap.reset(new IndexedHeap(capacity, arity));
+    }
+    else {
+        heap->clear();
+        heap->countInto(nullptr);
+    }
+
+    return *heap;
+}
+
+int IndexedHeap::capacity() const {
+    return positions.size();
+}
+
+int IndexedHeap::arity() const {
+    return d;
+}
+
+double IndexedHeap::priorityOf(int id) const {
+    return heap[positions[id]].priority;
+}
+
+void IndexedHeap::enqueue(int id, double priority) {
+
+    if (contains(id)) {
+        error("IndexedHeap::enqueue: ID is already in the heap");
+    }
+
+    heap.push_back({priority, id});
+    positions[id] = heap.size() - 1;
+    siftUp(heap.size() - 1);
+
+    if (counters != nullptr) {
+        counters->pushes++;
+        counters->peakOpenSet = max(counters->peakOpenSet, (long long) heap.size());
+    }
+}
+
+void IndexedHeap::decreaseKey(int id, double priority) {
+
+    int slot = positions[id];
+    if (slot == NOT_IN_HEAP or priority > heap[slot].priority) {
+        error("IndexedHeap::decreaseKey: ID is not in the heap or the priority is not lower");
+    }
+
+    heap[slot].priority = priority;
+    siftUp(slot);
+
+    if (counters != nullptr) {
+        counters->decreaseKeys++;
+    }
+}
+
+bool IndexedHeap::enqueueOrDecrease(int id, double priority) {
+
+    int slot = positions[id];
+    if (slot == NOT_IN_HEAP) {
+        enqueue(id, priority);
+        return true;
+    }
+    if (priority < heap[slot].priority) {
+        heap[slot].priority = priority;
+        siftUp(slot);
+        if (counters != nullptr) {
+            counters->decreaseKeys++;
+        }
+        return true;
+    }
+    return false;
+}
+
+int IndexedHeap::peek() const {
+    if (isEmpty()) {
+        error("IndexedHeap::peek: heap is empty");
+    }
+    return heap[0].id;
+}
+
+double IndexedHeap::peekPriority() const {
+    if (isEmpty()) {
+        error("IndexedHeap::peekPriority: heap is empty");
+    }
+    return heap[0].priority;
+}
+
+int IndexedHeap::dequeue() {
+
+    int front = peek();
+    positions[front] = NOT_IN_HEAP;
+
+    // Moving the last entry into the hole at the root and letting it sink
+    Entry last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        place(0, last);
+        siftDown(0);
+    }
+
+    if (counters != nullptr) {
+        counters->pops++;
+    }
+
+    return front;
+}
+
+void IndexedHeap::countInto(SearchCounters* counters) {
+    this->counters = counters;
+}
+
+void IndexedHeap::clear() {
+    for (const Entry& entry : heap) {
+        positions[entry.id] = NOT_IN_HEAP;
+    }
+    heap.clear();
+}
+
+/*
+ * Both sift directions move the displaced entry through a "hole" instead of swapping at
+ * every level, so each level costs one write instead of three.
+ */
+void IndexedHeap::siftUp(int slot) {
+
+    Entry entry = heap[slot];
+    while (slot > 0) {
+        int parent = (slot - 1) / d;
+        if (heap[parent].priority <= entry.priority) {
+            break;
+        }
+        place(slot, heap[parent]);
+        slot = parent;
+    }
+    place(slot, entry);
+}
+
+void IndexedHeap::siftDown(int slot) {
+
+    Entry entry = heap[slot];
+    int numEntries = heap.size();
+
+    while (true) {
+        int firstChild = d * slot + 1;
+        if (firstChild >= numEntries) {
+            break;
+        }
+
+        // Finding the smallest of the (up to d) children
+        int lastChild = min(firstChild + d, numEntries);
+        int best = firstChild;
+        for (int child = firstChild + 1; child < lastChild; child++) {
+            if (heap[child].priority < heap[best].priority) {
+                best = child;
+            }
+        }
+
+        if (entry.priority <= heap[best].priority) {
+            break;
+        }
+        place(slot, heap[best]);
+        slot = best;
+    }
+    place(slot, entry);
+}
+
+void IndexedHeap::place(int slot, const Entry& entry) {
+    heap[slot] = entry;
+    positions[entry.id] = slot;
+}
@@ -0,0 +1,138 @@
+/*
+ * This header declares the IndexedHeap class, an addressable d-ary min-heap of integer
+ * IDs in the range [0, capacity) ordered by a double priority.  Alongside the heap
+ * itself it keeps a table mapping every ID to its current slot in the heap, so that the
+ * priority of an ID that is already queued can be lowered in place (decrease-key).
+ * Dijkstra's algorithm and A* use it as their open set: each node is queued at most
+ * once, and a cheaper route to a queued node moves it up the heap instead of adding a
+ * stale duplicate.
+ *
+ * The arity (number of children per heap node) is configurable.  Wider heaps are
+ * shallower, which makes enqueue / decrease-key cheaper and dequeue more expensive.
+ *
+ * A heap can count its operations into SearchCounters (see SearchCounters.h).
+ */
+
+#pragma once
+
+#include <vector>
+
+struct SearchCounters;
+
+class IndexedHeap {
+public:
+    /* Arity used when none is given; a good default for road networks. */
+    static const int DEFAULT_ARITY = 4;
+
+    /*
+     * Constructs an empty heap that can hold the IDs 0 .. capacity - 1.
+     */
+    explicit IndexedHeap(int capacity, int arity = DEFAULT_ARITY);
+
+    /*
+     * Returns an empty heap owned by the calling thread that is reused by later calls
+     * with the same capacity, arity and slot, so that its ID table is not reallocated
+     * for every search.  The heap counts into no counters until countInto() is called.
+     */
+    static IndexedHeap& reusable(int capacity, int arity = DEFAULT_ARITY, int slot = 0);
+
+    /*
+     * Returns the number of IDs the heap can hold, and its arity.
+     */
+    int capacity() const;
+    int arity() const;
+
+    /*
+     * Returns the number of IDs currently in the heap.
+     */
+    int size() const;
+    bool isEmpty() const;
+
+    /*
+     * Returns whether the given ID is currently in the heap.
+     */
+    bool contains(int id) const;
+
+    /*
+     * Returns the current priority of an ID that is in the heap.
+     */
+    double priorityOf(int id) const;
+
+    /*
+     * Adds an ID that is not yet in the heap with the given priority.
+     */
+    void enqueue(int id, double priority);
+
+    /*
+     * Lowers the priority of an ID that is already in the heap.
+     */
+    void decreaseKey(int id, double priority);
+
+    /*
+     * Enqueues the ID if it is not in the heap, or lowers its priority if the new
+     * priority is smaller than its current one. Returns whether the heap changed.
+     */
+    bool enqueueOrDecrease(int id, double priority);
+
+    /*
+     * Returns the ID / priority at the front of the heap without removing it.
+     */
+    int peek() const;
+    double peekPriority() const;
+
+    /*
+     * Removes and returns the ID with the smallest priority.
+     */
+    int dequeue();
+
+    /*
+     * Removes every ID from the heap, in time proportional to the number removed.
+     */
+    void clear();
+
+    /*
+     * Makes the heap count its pushes, pops and decrease-keys, and its peak size, into the
+     * given counters from now on, or into none if they are null.
+     */
+    void countInto(SearchCounters* counters);
+
+private:
+    /* Value stored in the position table for IDs that are not in the heap. */
+    static const int NOT_IN_HEAP = -1;
+
+    /* One heap slot: the ID and its priority are stored together so that comparisons
+     * while sifting do not have to chase the ID into a separate priority table.
+     */
+    struct Entry {
+        double priority;
+        int id;
+    };
+
+    int d;                         // arity
+    std::vector<Entry> heap;       // the heap itself, children of slot i at d * i + 1 ..
+    std::vector<int> positions;    // ID -> slot in heap, or NOT_IN_HEAP
+    SearchCounters* counters;      // where to count operations, if anywhere
+
+    /*
+     * Moves the entry at the given slot up / down until the heap order is restored.
+     */
+    void siftUp(int slot);
+    void siftDown(int slot);
+
+    /*
+     * Writes the entry into the given slot and records its new position.
+     */
+    void place(int slot, const Entry& entry);
+};
+
+inline int IndexedHeap::size() const {
+    return heap.size();
+}
+
+inline bool IndexedHeap::isEmpty() const {
+    return heap.empty();
+}
+
+inline bool IndexedHeap::contains(int id) const {
+    return positions[id] != NOT_IN_HEAP;
+}
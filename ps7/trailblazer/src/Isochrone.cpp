@@ -0,0 +1,102 @@
+/*
+ * This sourcecode file implements the Isochrone class declared in Isochrone.h.
+ */
+
+#include <algorithm>
+#include <cfloat>
+
+#include "error.h"
+#include "Isochrone.h"
+using namespace std;
+
+Isochrone::Isochrone(const RoadGraph& graph, RoadNode* source, const SearchOptions& options)
+    : compact(graph.compact()),
+      options(options),
+      sourceId(compact.indexOf(source)),
+      searchedBudget(0.0),
+      space(compact),
+      openSet(compact.nodeCount(), options.heapArity) {
+
+    if (sourceId == CompactRoadGraph::NO_NODE) {
+        error("Isochrone: the source must be part of the graph");
+    }
+
+    openSet.countInto(options.counters);
+    space.relax(sourceId, SearchSpace::NO_PARENT, 0.0);
+    openSet.enqueue(sourceId, 0.0);
+    extendTo(0.0);
+}
+
+RoadNode* Isochrone::source() const {
+    return compact.nodeAt(sourceId);
+}
+
+double Isochrone::budget() const {
+    return searchedBudget;
+}
+
+/*
+ * This is the main loop of dijkstrasAlgorithm() with the end test replaced by the budget
+ * test, which leaves every node costing more than the budget in the open set for the next
+ * extension.  Settled nodes are final, so resuming gives the same result as a search that
+ * ran with the larger budget from the start.
+ */
+void Isochrone::extendTo(double budget) {
+
+    SearchTimer timer(options.counters);
+    while (!openSet.isEmpty() and openSet.peekPriority() <= budget) {
+
+        int nodeId = openSet.dequeue();
+        space.markVisited(nodeId);
+        reportSettled(compact.nodeAt(nodeId), options);
+
+        double currCost = space.distanceTo(nodeId);
+        settledOrder.push_back(nodeId);
+        settledCosts.push_back(currCost);
+        reportRelaxed(compact.endEdge(nodeId) - compact.firstEdge(nodeId), options);
+
+        for (int edge = compact.firstEdge(nodeId); edge < compact.endEdge(nodeId); edge++) {
+            int neighborId = compact.edgeTarget(edge);
+            if (space.isVisited(neighborId)) {
+                continue;
+            }
+            double updatedCost = currCost + compact.edgeCost(edge);
+            if (updatedCost < space.distanceTo(neighborId)) {
+                space.relax(neighborId, nodeId, updatedCost);
+                openSet.enqueueOrDecrease(neighborId, updatedCost);
+                reportFringe(compact.nodeAt(neighborId), options);
+            }
+        }
+    }
+    searchedBudget = max(searchedBudget, budget);
+}
+
+Vector<Isochrone::Reached> Isochrone::reachable(double budget) {
+
+    int numReached = reachableCount(budget);
+    Vector<Reached> result;
+    for (int ii = 0; ii < numReached; ii++) {
+        result.add({compact.nodeAt(settledOrder[ii]), settledCosts[ii]});
+    }
+    return result;
+}
+
+int Isochrone::reachableCount(double budget) {
+    extendTo(budget);
+    return upper_bound(settledCosts.begin(), settledCosts.end(), budget) - settledCosts.begin();
+}
+
+double Isochrone::costTo(RoadNode* node) const {
+    int id = compact.indexOf(node);
+    if (id == CompactRoadGraph::NO_NODE or !space.isVisited(id)) {
+        return DBL_MAX;
+    }
+    return space.distanceTo(id);
+}
+
+Path Isochrone::pathTo(RoadNode* node) const {
+    if (costTo(node) == DBL_MAX) {
+        return {};
+    }
+    return space.pathTo(compact.indexOf(node));
+}
@@ -0,0 +1,104 @@
+/*
+ * This header declares the Isochrone class, which answers reachability queries around a
+ * fixed source: which nodes can be reached from it within a cost budget (e.g. "everything
+ * within 15 minutes of the depot"), and at what cost.
+ *
+ * It runs Dijkstra's algorithm from the source, but only until the next node to settle
+ * costs more than the budget, and then keeps the search where it stopped: its tables, its
+ * open set (the frontier), and the order in which it settled nodes.  A later query with a
+ * larger budget resumes the search from that frontier instead of starting over, and one
+ * with a smaller budget needs no search at all.  Dijkstra's algorithm settles nodes in
+ * order of increasing cost, so the nodes within any budget searched so far are a prefix
+ * of the settled order, found by binary search.
+ *
+ * The search reads the edge costs as they are whenever it resumes, so costs should not
+ * change while an Isochrone is in use; construct a new one after they do.
+ */
+
+#pragma once
+
+#include <vector>
+#include "vector.h"
+#include "CompactRoadGraph.h"
+#include "IndexedHeap.h"
+#include "RoadGraph.h"
+#include "SearchOptions.h"
+#include "SearchSpace.h"
+#include "Trailblazer.h"
+
+class Isochrone {
+public:
+    /*
+     * One node within the budget, and the cost of the cheapest path to it from the source.
+     */
+    struct Reached {
+        RoadNode* node;
+        double cost;
+    };
+
+    /*
+     * Prepares to answer queries around the source, settling just the nodes that are no
+     * cost away from it (the source itself and any reached over free edges).  The options
+     * (including any counters they point to) are used by every later search; the landmarks
+     * and arcFlags settings steer searches toward one end, so they are ignored.
+     */
+    Isochrone(const RoadGraph& graph, RoadNode* source,
+              const SearchOptions& options = SearchOptions());
+
+    /*
+     * Returns the node the queries are answered around.
+     */
+    RoadNode* source() const;
+
+    /*
+     * Returns the largest budget searched so far (at first 0), within which every node is
+     * already settled.
+     */
+    double budget() const;
+
+    /*
+     * Extends the search until every node whose cheapest path from the source costs at
+     * most the given budget is settled.  Does nothing if the budget was searched before.
+     */
+    void extendTo(double budget);
+
+    /*
+     * Returns every node whose cheapest path from the source costs at most the given
+     * budget, including the source itself, in order of increasing cost.  Extends the
+     * search first if needed.
+     */
+    Vector<Reached> reachable(double budget);
+
+    /*
+     * Returns the number of nodes that reachable() would return for the budget, without
+     * building the list.
+     */
+    int reachableCount(double budget);
+
+    /*
+     * Returns the cost of the cheapest path from the source to the node, or DBL_MAX if it
+     * costs more than the largest budget searched so far.
+     */
+    double costTo(RoadNode* node) const;
+
+    /*
+     * Returns the cheapest path from the source to the node, or an empty path if it costs
+     * more than the largest budget searched so far.
+     */
+    Path pathTo(RoadNode* node) const;
+
+private:
+    const CompactRoadGraph& compact;
+    SearchOptions options;
+    int sourceId;
+    double searchedBudget;
+
+    SearchSpace space;                   // distances and predecessors of the search so far
+    IndexedHeap openSet;                 // the frontier the next extension resumes from
+    std::vector<int> settledOrder;       // settled nodes, in order of increasing cost
+    std::vector<double> settledCosts;    // their costs, searched by reachableCount()
+
+    /* The search state would be expensive to copy, so an Isochrone cannot be copied. */
+    Isochrone(const Isochrone&) = delete;
+    Isochrone& operator=(const Isochrone&) = delete;
+};
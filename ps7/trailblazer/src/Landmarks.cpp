@@ -0,0 +1,119 @@
+/*
+ * This sourcecode file implements the Landmarks class declared in Landmarks.h.
+ */
+
+#include <algorithm>
+
+#include "error.h"
+#include "IndexedHeap.h"
+#include "Landmarks.h"
+using namespace std;
+
+Landmarks::Landmarks(const RoadGraph& graph, int count)
+    : graph(graph.compact()) {
+
+    if (count < 1) {
+        error("Landmarks: at least one landmark is required");
+    }
+    chooseLandmarks(min(count, this->graph.nodeCount()));
+}
+
+Landmarks::Landmarks(const CompactRoadGraph& graph)
+    : graph(graph) {
+    // Everything else handled by default
+}
+
+const CompactRoadGraph& Landmarks::compactGraph() const {
+    return graph;
+}
+
+int Landmarks::count() const {
+    return landmarks.size();
+}
+
+int Landmarks::landmarkAt(int index) const {
+    return landmarks[index];
+}
+
+/*
+ * Farthest selection.  The first landmark is the node farthest from an arbitrary node;
+ * after that, minDistances tracks each node's distance from its closest landmark, and
+ * the node with the largest one is taken next.  Nodes that no landmark reaches count as
+ * infinitely far away, so every part of a disconnected map gets a landmark of its own
+ * before any part gets a second one.  The forward search from each new landmark is kept
+ * as its column of fromLandmark, so the selection costs no extra searches.
+ */
+void Landmarks::chooseLandmarks(int count) {
+
+    int numNodes = graph.nodeCount();
+    vector<int> chosen;
+    vector<double> fromTable(numNodes * count, DBL_MAX);
+    vector<double> toTable(numNodes * count, DBL_MAX);
+    if (numNodes == 0) {
+        return;
+    }
+
+    vector<double> distances;
+    distancesFrom(0, true, distances);
+    int next = 0;
+    for (int node = 0; node < numNodes; node++) {
+        if (distances[node] != DBL_MAX and distances[node] > distances[next]) {
+            next = node;
+        }
+    }
+
+    vector<double> minDistances(numNodes, DBL_MAX);
+    for (int landmark = 0; landmark < count; landmark++) {
+
+        chosen.push_back(next);
+
+        distancesFrom(next, true, distances);
+        for (int node = 0; node < numNodes; node++) {
+            fromTable[node * count + landmark] = distances[node];
+            minDistances[node] = min(minDistances[node], distances[node]);
+        }
+
+        distancesFrom(next, false, distances);
+        for (int node = 0; node < numNodes; node++) {
+            toTable[node * count + landmark] = distances[node];
+        }
+
+        // Landmarks themselves are at distance zero, so they are never picked twice
+        next = max_element(minDistances.begin(), minDistances.end()) - minDistances.begin();
+    }
+
+    landmarks = FlatArray<int>(move(chosen));
+    fromLandmark = FlatArray<double>(move(fromTable));
+    toLandmark = FlatArray<double>(move(toTable));
+}
+
+/*
+ * A plain Dijkstra search over the outgoing (forward) or incoming (backward) CSR arrays
+ * that runs until every reachable node is settled.  It does not color any nodes.
+ */
+void Landmarks::distancesFrom(int source, bool forward, vector<double>& distances) const {
+
+    distances.assign(graph.nodeCount(), DBL_MAX);
+    distances[source] = 0.0;
+
+    IndexedHeap openSet(graph.nodeCount(), IndexedHeap::DEFAULT_ARITY);
+    openSet.enqueue(source, 0.0);
+
+    while (!openSet.isEmpty()) {
+
+        int node = openSet.dequeue();
+        double currCost = distances[node];
+
+        int firstEdge = forward ? graph.firstEdge(node) : graph.firstInEdge(node);
+        int endEdge = forward ? graph.endEdge(node) : graph.endInEdge(node);
+
+        for (int edge = firstEdge; edge < endEdge; edge++) {
+            int neighbor = forward ? graph.edgeTarget(edge) : graph.inEdgeSource(edge);
+            double updatedCost = currCost + (forward ? graph.edgeCost(edge) : graph.inEdgeCost(edge));
+            if (updatedCost < distances[neighbor]) {
+                distances[neighbor] = updatedCost;
+                openSet.enqueueOrDecrease(neighbor, updatedCost);
+            }
+        }
+    }
+}
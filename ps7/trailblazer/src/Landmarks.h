@@ -0,0 +1,117 @@
+/*
+ * This header declares the Landmarks class, which supplies the ALT (A*, Landmarks,
+ * Triangle inequality) heuristic for A*.
+ *
+ * A handful of landmark nodes are chosen up front, and the exact cost from every landmark
+ * to every node and from every node back to every landmark is stored.  For any landmark L,
+ * the triangle inequality bounds the cost from v to t from below by both
+ *     d(L, t) - d(L, v)    and    d(v, L) - d(t, L),
+ * and the largest of these bounds over all landmarks is used as the A* potential.  Unlike
+ * the crow-fly estimate it follows the actual roads, so a single fast highway somewhere
+ * on the map does not weaken it everywhere.  The bound is consistent, so A* still settles
+ * every node at most once and returns shortest paths.
+ *
+ * Landmarks are chosen by farthest selection: each new landmark is the node farthest from
+ * the landmarks chosen so far, which spreads them around the edges of the map, where they
+ * give the tightest bounds.
+ *
+ * The tables are built from the graph's CSR snapshot and must be rebuilt if edges are
+ * added to the graph or their costs change.  Pass them to the searches through
+ * SearchOptions::landmarks, and save them in a RoutingIndex to reuse them across runs.
+ */
+
+#pragma once
+
+#include <cfloat>
+#include <vector>
+#include "CompactRoadGraph.h"
+#include "FlatArray.h"
+#include "RoadGraph.h"
+
+class Landmarks {
+public:
+    /* Number of landmarks chosen when no count is given. */
+    static const int DEFAULT_COUNT = 8;
+
+    /*
+     * Chooses count landmarks (or every node, in graphs with fewer nodes) and computes
+     * their distance tables.
+     */
+    explicit Landmarks(const RoadGraph& graph, int count = DEFAULT_COUNT);
+
+    /*
+     * Returns the CSR snapshot whose dense node IDs the tables use.
+     */
+    const CompactRoadGraph& compactGraph() const;
+
+    /*
+     * Returns the number of landmarks.
+     */
+    int count() const;
+
+    /*
+     * Returns the dense ID of the landmark with the given index.
+     */
+    int landmarkAt(int index) const;
+
+    /*
+     * Returns a lower bound on the cost of the cheapest path from node to target, where
+     * both are dense IDs.
+     */
+    double lowerBound(int node, int target) const;
+
+private:
+    const CompactRoadGraph& graph;
+    FlatArray<int> landmarks;      // landmark index -> dense ID
+
+    /* The distance tables, indexed by node * count() + landmark so that the bounds for
+     * one node are contiguous.  Unreachable entries hold DBL_MAX.
+     */
+    FlatArray<double> fromLandmark;  // d(landmark, node)
+    FlatArray<double> toLandmark;    // d(node, landmark)
+
+    /* A RoutingIndex fills in the tables of the landmarks it loads. */
+    friend class RoutingIndex;
+
+    /*
+     * Constructs landmarks over the given snapshot with empty tables, for a RoutingIndex
+     * to fill in.
+     */
+    explicit Landmarks(const CompactRoadGraph& graph);
+
+    /*
+     * Computes the cost from source to every node (forward) or from every node to source
+     * (backward) with a one-to-all Dijkstra search.
+     */
+    void distancesFrom(int source, bool forward, std::vector<double>& distances) const;
+
+    /*
+     * Chooses the landmarks and fills in both distance tables.
+     */
+    void chooseLandmarks(int count);
+};
+
+/*
+ * The bound is evaluated once per relaxed edge, so it is defined here where the compiler
+ * can inline it.  Landmarks that cannot reach one of the two nodes (or be reached from
+ * it) say nothing about the pair and are skipped.
+ */
+inline double Landmarks::lowerBound(int node, int target) const {
+
+    int numLandmarks = landmarks.size();
+    const double* fromNode = &fromLandmark[node * numLandmarks];
+    const double* fromTarget = &fromLandmark[target * numLandmarks];
+    const double* toNode = &toLandmark[node * numLandmarks];
+    const double* toTarget = &toLandmark[target * numLandmarks];
+
+    double bound = 0.0;
+    for (int ii = 0; ii < numLandmarks; ii++) {
+        if (fromTarget[ii] != DBL_MAX and fromNode[ii] != DBL_MAX and fromTarget[ii] - fromNode[ii] > bound) {
+            bound = fromTarget[ii] - fromNode[ii];
+        }
+        if (toNode[ii] != DBL_MAX and toTarget[ii] != DBL_MAX and toNode[ii] - toTarget[ii] > bound) {
+            bound = toNode[ii] - toTarget[ii];
+        }
+    }
+    return bound;
+}
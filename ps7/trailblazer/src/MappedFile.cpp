@@ -0,0 +1,84 @@
+/*
+ * This sourcecode file implements the MappedFile class declared in MappedFile.h.
+ */
+
+#include <fstream>
+
+#include "MappedFile.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+MappedFile::MappedFile(const string& filename)
+    : opened(false),
+      contents(nullptr),
+      length(0),
+      mapped(false) {
+
+#if !defined(_WIN32)
+    int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor >= 0) {
+        struct stat info;
+        if (fstat(descriptor, &info) == 0 and S_ISREG(info.st_mode)) {
+            opened = true;
+            length = info.st_size;
+            if (length > 0) {
+                void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                if (address != MAP_FAILED) {
+                    contents = static_cast<const char*>(address);
+                    mapped = true;
+                }
+            }
+        }
+        close(descriptor);
+        if (mapped or length == 0) {
+            return;
+        }
+        opened = false;
+        length = 0;
+    }
+#endif
+
+    // Falling back to reading the whole file into the buffer
+    ifstream input(filename.c_str(), ios::binary | ios::ate);
+    if (input.fail()) {
+        return;
+    }
+    streamoff fileSize = input.tellg();
+    buffer.resize(fileSize);
+    input.seekg(0);
+    if (fileSize > 0 and !input.read(buffer.data(), fileSize)) {
+        buffer.clear();
+        return;
+    }
+
+    opened = true;
+    contents = buffer.data();
+    length = buffer.size();
+}
+
+MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+    if (mapped) {
+        munmap(const_cast<char*>(contents), length);
+    }
+#endif
+}
+
+bool MappedFile::isOpen() const {
+    return opened;
+}
+
+const char* MappedFile::data() const {
+    return contents;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
@@ -0,0 +1,49 @@
+/*
+ * This header declares the MappedFile class, which gives read-only access to the whole
+ * contents of a file as one block of memory.  Where the operating system supports it the
+ * file is memory-mapped, so opening it costs nothing up front and pages are only read as
+ * they are touched; elsewhere the file is read into a buffer in a single call.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class MappedFile {
+public:
+    /*
+     * Opens the file with the given name.  If it cannot be opened, isOpen() is false and
+     * the contents are empty.
+     */
+    explicit MappedFile(const std::string& filename);
+
+    /*
+     * Unmaps the file.
+     */
+    ~MappedFile();
+
+    /*
+     * Returns whether the file was opened successfully.
+     */
+    bool isOpen() const;
+
+    /*
+     * Returns the contents of the file and their size in bytes.  The contents stay valid
+     * for the lifetime of the MappedFile and must not be written to.
+     */
+    const char* data() const;
+    size_t size() const;
+
+private:
+    bool opened;
+    const char* contents;
+    size_t length;
+    bool mapped;                 // whether contents is a mapping (as opposed to buffer)
+    std::vector<char> buffer;    // the contents, when the file could not be mapped
+
+    /* A MappedFile owns its mapping, so it cannot be copied. */
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
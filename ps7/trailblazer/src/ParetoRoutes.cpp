@@ -0,0 +1,178 @@
+/*
+ * This sourcecode file implements the Pareto route search declared in ParetoRoutes.h.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "CompactRoadGraph.h"
+#include "ParetoRoutes.h"
+#include "SearchSpace.h"
+using namespace std;
+
+/* Private types and helper functions only needed in this file. */
+namespace {
+    /* Index reported for the predecessor of a label that has none (the one at start). */
+    const int NO_LABEL = -1;
+
+    /*
+     * One way of reaching a node: the cost and length of the route that got there, and the
+     * label at the previous node of that route.
+     */
+    struct Label {
+        double cost;
+        double length;
+        int node;
+        int parent;
+    };
+
+    /*
+     * The labels of one search, in one flat array that labels refer to each other by index,
+     * and the open set: a binary heap of the labels not yet settled, cheapest then shortest
+     * on top.  The heap entries repeat the label's cost and length so that ordering them
+     * does not have to look the labels up.
+     */
+    class LabelPool {
+    public:
+        /*
+         * Returns the pool owned by the calling thread, emptied for a new search but
+         * keeping the memory it grew to in earlier ones.
+         */
+        static LabelPool& reusable() {
+            static thread_local LabelPool pool;
+            pool.labels.clear();
+            pool.openSet.clear();
+            return pool;
+        }
+
+        /*
+         * Adds a label and puts it in the open set.
+         */
+        void push(double cost, double length, int node, int parent) {
+            openSet.push_back({cost, length, (int) labels.size()});
+            push_heap(openSet.begin(), openSet.end(), Entry::later);
+            labels.push_back({cost, length, node, parent});
+        }
+
+        /*
+         * Returns whether every label has left the open set.
+         */
+        bool isEmpty() const {
+            return openSet.empty();
+        }
+
+        /*
+         * Removes the cheapest (then shortest) label from the open set and returns its index.
+         */
+        int pop() {
+            pop_heap(openSet.begin(), openSet.end(), Entry::later);
+            int index = openSet.back().label;
+            openSet.pop_back();
+            return index;
+        }
+
+        /*
+         * Returns the label with the given index.  Pushing may move the labels, so the
+         * reference is only good until the next push().
+         */
+        const Label& operator[](int index) const {
+            return labels[index];
+        }
+
+        /*
+         * Returns the route that the label with the given index ends.
+         */
+        Path pathTo(int index, const CompactRoadGraph& graph) const {
+
+            // Counting the nodes first so that the path can be filled in from the back
+            int numNodes = 0;
+            for (int curr = index; curr != NO_LABEL; curr = labels[curr].parent) {
+                numNodes++;
+            }
+
+            Path path(numNodes, nullptr);
+            for (int curr = index; curr != NO_LABEL; curr = labels[curr].parent) {
+                path[--numNodes] = graph.nodeAt(labels[curr].node);
+            }
+            return path;
+        }
+
+    private:
+        struct Entry {
+            double cost;
+            double length;
+            int label;
+
+            /* Heap order: the entry that should come out later sorts first. */
+            static bool later(const Entry& lhs, const Entry& rhs) {
+                return lhs.cost > rhs.cost or (lhs.cost == rhs.cost and lhs.length > rhs.length);
+            }
+        };
+
+        vector<Label> labels;
+        vector<Entry> openSet;
+    };
+}
+
+/*
+ * The search space keeps, as the "distance" of each node, the length of the last label
+ * settled there (which is the shortest, see ParetoRoutes.h), and caches the Euclidean
+ * distance from each node to end as its potential.  Lengths use the true Euclidean
+ * distance rather than crowFlyDistance(): with its -1, edges between co-located nodes
+ * would have negative length, and the distance to go would not bound a multi-edge rest.
+ * Labels still in the open set may turn out to be dominated by ones pushed after them, so
+ * the dominance test is repeated when a label is settled.
+ */
+Vector<ParetoRoute> paretoRoutes(const RoadGraph& graph, RoadNode* start, RoadNode* end,
+                                 const SearchOptions& options) {
+
+    SearchTimer timer(options.counters);
+    const CompactRoadGraph& compact = graph.compact();
+    SearchSpace& space = SearchSpace::reusable(compact);
+    LabelPool& pool = LabelPool::reusable();
+    int startId = space.idOf(start);
+    int endId = space.idOf(end);
+
+    auto lengthToGo = [&](int nodeId) {
+        if (!space.hasPotential(nodeId)) {
+            space.setPotential(nodeId, compact.euclideanDistance(nodeId, endId));
+        }
+        return space.potentialOf(nodeId);
+    };
+
+    // Dominated by a label settled at the node, or every way on to end is dominated by a route found
+    auto isDominated = [&](int nodeId, double length) {
+        return length >= space.distanceTo(nodeId)
+               or length + lengthToGo(nodeId) >= space.distanceTo(endId);
+    };
+
+    Vector<ParetoRoute> front;
+    pool.push(0.0, 0.0, startId, NO_LABEL);
+
+    while (!pool.isEmpty()) {
+
+        int index = pool.pop();
+        Label label = pool[index];
+        if (isDominated(label.node, label.length)) {
+            continue;
+        }
+        space.relax(label.node, SearchSpace::NO_PARENT, label.length);
+        reportSettled(compact.nodeAt(label.node), options);
+
+        if (label.node == endId) {
+            front.add({pool.pathTo(index, compact), label.cost, label.length});
+            continue;
+        }
+
+        reportRelaxed(compact.endEdge(label.node) - compact.firstEdge(label.node), options);
+        for (int edge = compact.firstEdge(label.node); edge < compact.endEdge(label.node); edge++) {
+            int neighborId = compact.edgeTarget(edge);
+            double length = label.length + compact.euclideanDistance(label.node, neighborId);
+            if (!isDominated(neighborId, length)) {
+                pool.push(label.cost + compact.edgeCost(edge), length, neighborId, index);
+                reportFringe(compact.nodeAt(neighborId), options);
+            }
+        }
+    }
+
+    return front;
+}
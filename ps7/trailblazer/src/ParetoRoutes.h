@@ -0,0 +1,45 @@
+/*
+ * This header declares paretoRoutes(), a multi-criteria search that weighs two things at
+ * once: the cost of a route (the sum of its RoadEdge::cost() values, i.e. its travel time)
+ * and its geometric length (the sum of the Euclidean distances between the endpoints of
+ * its edges).  Instead of one cheapest route it returns every Pareto-optimal one: each
+ * route is shorter than every route that costs less, so no route in the list is beaten on
+ * both counts by any other.  A caller can then pick whichever trade-off it likes, which
+ * no single weighted combination of the two criteria is guaranteed to find.
+ *
+ * The search is label-setting: a node may hold many labels (cost, length, predecessor),
+ * one per non-dominated way of reaching it, and labels are settled in order of increasing
+ * cost (then length).  Settled labels at a node therefore get strictly shorter, so a new
+ * label is dominated exactly when it is no shorter than the node's last settled label,
+ * which takes one comparison instead of a scan of the node's labels.  Labels whose every
+ * extension would be no shorter than a route already found to the end (by the Euclidean
+ * distance still to go) are pruned too.  The labels live in a pool that is owned by the
+ * calling thread and reused by later searches, so a search allocates nothing once the
+ * pool has grown to the size of the largest search so far.
+ */
+
+#pragma once
+
+#include "vector.h"
+#include "RoadGraph.h"
+#include "SearchOptions.h"
+#include "Trailblazer.h"
+
+/*
+ * One route on the Pareto front, with its cost and its length.
+ */
+struct ParetoRoute {
+    Path path;
+    double cost;
+    double length;
+};
+
+/*
+ * Returns the Pareto front of routes from start to end over cost and length, ordered by
+ * increasing cost (and so by decreasing length).  Routes that tie on both criteria are
+ * reported once.  The list is empty if end cannot be reached, and holds the single route
+ * {start} if start is end.  Each settled label is reported as a settled node; the
+ * landmarks and arcFlags settings only bound the cost, so they are ignored.
+ */
+Vector<ParetoRoute> paretoRoutes(const RoadGraph& graph, RoadNode* start, RoadNode* end,
+                                 const SearchOptions& options = SearchOptions());
@@ -11,6 +11,8 @@
 
 
 #include "RoadGraph.h"
+#include "CompactRoadGraph.h"
+#include "error.h"
 #include "point.h"
 #include <math.h>
 #include <sstream>
@@ -32,6 +34,34 @@ namespace {
          */
         return fmax(sqrt(dx * dx + dy * dy), 0) - 1;
     }
+
+    /*
+     * The speed at which the edge is travelled, or 0 if it is too short to say.
+     */
+    double edgeRate(RoadEdge* edge) {
+        /* Travel time is equal to the edge cost. */
+        double time = edge->cost();
+
+        /* Compute the distance between the two points. */
+        Point a = edge->from()->location();
+        Point b = edge->to()->location();
+
+        /* piech confirms that this might be a workaround for an earlier issue.
+         *
+         * FIXME: This subtracts 1 twice: once in pointDistance and once here.
+         *        Is this intentional?
+         * FIXME: Is this necessary?
+         */
+        double dist = pointDistance(a, b) - 1;
+
+        /* piech confirms that this is likely a workaround for an earlier issue.
+         *
+         * FIXME: Is this necessary?
+         */
+        if (dist <= 3) return 0.0;
+
+        return dist / time;
+    }
 }
 
 /* Constructs a new road node with the given name. */
@@ -103,6 +133,17 @@ std::string RoadEdge::toString() const {
  */
 RoadGraph::RoadGraph(Graph<RoadNode, RoadEdge>* data) {
     this->data = data;
+
+    /* Look at every edge in the network and find the one that has the highest travel rate.
+     * This is done up front so that the A* heuristic, which divides by it for every node it
+     * estimates, only reads a member.
+     */
+    for(RoadEdge* edge: data->getArcSet()) {
+        double rate = edgeRate(edge);
+        if(rate > maxRate) {
+            maxRate = rate;
+        }
+    }
 }
 
 /*
@@ -131,39 +172,41 @@ double RoadGraph::crowFlyDistanceBetween(RoadNode* start, RoadNode* end) const {
 }
 
 /*
- * Returns the maximum speed of any edge on the road graph.
+ * Returns the CSR snapshot of the graph, building it on first use.
  */
-double RoadGraph::maxRoadSpeed() const {
-    if(maxRateCached) return maxRate;
-
-    /* Look at every edge in the network and find the one that has the highest travel rate. */
-    for(RoadEdge* edge: data->getArcSet()) {
-        /* Travel time is equal to the edge cost. */
-        double time = edge->cost();
-
-        /* Compute the distance between the two points. */
-        Point a = edge->from()->location();
-        Point b = edge->to()->location();
+const CompactRoadGraph& RoadGraph::compact() const {
+    if (!compactData) {
+        compactData = std::make_shared<CompactRoadGraph>(*data);
+    }
+    return *compactData;
+}
 
-        /* piech confirms that this might be a workaround for an earlier issue.
-         *
-         * FIXME: This subtracts 1 twice: once in pointDistance and once here.
-         *        Is this intentional?
-         * FIXME: Is this necessary?
-         */
-        double dist = pointDistance(a, b) - 1;
+/*
+ * Returns the maximum speed of any edge on the road graph, as computed when the graph was
+ * made and raised by setEdgeCost() since.
+ */
+double RoadGraph::maxRoadSpeed() const {
+    return maxRate;
+}
 
-        /* piech confirms that this is likely a workaround for an earlier issue.
-         *
-         * FIXME: Is this necessary?
-         */
-        if (dist <= 3) continue;
+/*
+ * Changes the cost of an edge. The saved maximum speed only ever goes up here: a slower
+ * edge leaves it a valid (if looser) upper bound, which keeps A* admissible without
+ * rescanning every edge.
+ */
+void RoadGraph::setEdgeCost(RoadEdge* edge, double cost) {
+    if (cost < 0) {
+        error("RoadGraph::setEdgeCost: edge costs cannot be negative");
+    }
 
-        double rate = dist / time;
-        if(rate > maxRate) {
-            maxRate = rate;
+    if (compactData) {
+        int index = compactData->edgeIndexOf(edge);
+        if (index == CompactRoadGraph::NO_EDGE) {
+            error("RoadGraph::setEdgeCost: the edge is not part of this graph");
         }
+        compactData->setEdgeCost(index, cost);
     }
-    maxRateCached = true;
-    return maxRate;
+    edge->edgeCost = cost;
+
+    maxRate = fmax(maxRate, edgeRate(edge));
 }
@@ -16,6 +16,7 @@
 #include "point.h"
 #include "observable.h"
 #include "Color.h"
+#include <memory>
 #include <string>
 
 /* Forward declarations of the relevant types so that RoadNode can reference RoadEdge
@@ -23,6 +24,7 @@
  */
 class RoadNode;
 class RoadEdge;
+class CompactRoadGraph;
 
 class RoadNode: public Observable<Color> {
 public:
@@ -119,7 +121,8 @@ public:
     RoadEdge* edgeBetween(RoadNode* start, RoadNode* end) const;
 
     /*
-     * Returns the maximum speed of any edge on the road graph.
+     * Returns the maximum speed of any edge on the road graph.  It is found when the
+     * RoadGraph is made, so (as with the CSR snapshot) no edges may be added afterwards.
      */
     double maxRoadSpeed() const;
 
@@ -131,11 +134,28 @@ public:
      */
     double crowFlyDistanceBetween(RoadNode* start, RoadNode* end) const;
 
+    /*
+     * Returns a compressed-sparse-row snapshot of the graph, built the first
+     * time it is requested and reused afterwards. See CompactRoadGraph.h.
+     */
+    const CompactRoadGraph& compact() const;
+
+    /*
+     * Changes the cost of the given edge, e.g. to follow live traffic, and updates the CSR
+     * snapshot and the maximum road speed to match.  Searches see the new cost from their
+     * next run on; contraction hierarchies and landmark tables built earlier keep the old
+     * costs and must be rebuilt (see DynamicRoute.h for repairing a route in place).  The
+     * cost must not be negative, and no search may be running on the graph meanwhile.
+     */
+    void setEdgeCost(RoadEdge* edge, double cost);
+
 private:
     // underlying data
     Graph<RoadNode, RoadEdge>* data;
 
-    // the saved max rate of the graph
-    mutable bool maxRateCached = false;
-    mutable double maxRate = 0.0;
+    // the saved CSR snapshot of the graph (shared by copies of this RoadGraph)
+    mutable std::shared_ptr<CompactRoadGraph> compactData;
+
+    // the max rate of the graph, found when it is made
+    double maxRate = 0.0;
 };
@@ -0,0 +1,481 @@
+/*
+ * This sourcecode file implements the RoutingIndex class declared in RoutingIndex.h.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "RoutingIndex.h"
+using namespace std;
+
+/* Private types and helper functions only needed in this file. */
+namespace {
+    /*
+     * The index format, all in the byte order of the machine that wrote it:
+     *     IndexHeader
+     *     SectionEntry[sectionCount]
+     *     the sections, each padded to start at a multiple of 8 bytes
+     * Every section is a flat array of one kind of element, and the table records its
+     * element size as well as its length, so a build whose structs are laid out
+     * differently rejects the file instead of misreading it.  Single numbers are stored
+     * as sections of length 1.
+     */
+    const char INDEX_MAGIC[8] = {'T', 'B', 'I', 'N', 'D', 'E', 'X', '\0'};
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    enum SectionKind : uint32_t {
+        SNAPSHOT_OFFSETS = 1,         // int[nodeCount + 1]: CompactRoadGraph::firstEdge() of each node, then edgeCount
+        SNAPSHOT_TARGETS,             // int[edgeCount]
+        SNAPSHOT_COSTS,               // double[edgeCount]
+        SNAPSHOT_COORDINATES,         // double[2 * nodeCount]: x and y of each node
+
+        HIERARCHY_RANKS = 100,        // int[nodeCount]
+        HIERARCHY_ARCS,               // ContractionHierarchy::Arc[]
+        HIERARCHY_SHORTCUT_COUNT,     // int[1]
+        HIERARCHY_UPWARD_OFFSETS,     // the four arrays of ContractionHierarchy::upward
+        HIERARCHY_UPWARD_OTHERS,
+        HIERARCHY_UPWARD_COSTS,
+        HIERARCHY_UPWARD_ARC_IDS,
+        HIERARCHY_DOWNWARD_OFFSETS,   // the four arrays of ContractionHierarchy::downward
+        HIERARCHY_DOWNWARD_OTHERS,
+        HIERARCHY_DOWNWARD_COSTS,
+        HIERARCHY_DOWNWARD_ARC_IDS,
+
+        LANDMARK_IDS = 200,           // int[count]
+        LANDMARK_FROM,                // double[nodeCount * count]
+        LANDMARK_TO,                  // double[nodeCount * count]
+
+        ARC_FLAG_REGION_COUNT = 300,  // int[1]
+        ARC_FLAG_REGIONS,             // int[nodeCount]
+        ARC_FLAG_FLAGS                // uint64_t[edgeCount]
+    };
+
+    struct IndexHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;          // BYTE_ORDER_MARK as the writer stored it
+        uint32_t nodeCount;
+        uint32_t edgeCount;
+        uint32_t sectionCount;
+        uint32_t reserved;
+    };
+
+    struct SectionEntry {
+        uint32_t kind;
+        uint32_t elementSize;
+        uint64_t offset;             // from the start of the file
+        uint64_t count;              // number of elements
+    };
+
+    static_assert(sizeof(IndexHeader) % 8 == 0 and sizeof(SectionEntry) % 8 == 0,
+                  "index sections must stay 8-byte aligned");
+
+    /*
+     * A section that save() is about to write, pointing at its elements in memory.
+     */
+    struct PendingSection {
+        uint32_t kind;
+        uint32_t elementSize;
+        uint64_t count;
+        const void* elements;
+    };
+
+    template <typename ValueType>
+    void addSection(vector<PendingSection>& sections, SectionKind kind, const ValueType* elements, size_t count) {
+        sections.push_back({kind, uint32_t(sizeof(ValueType)), count, elements});
+    }
+
+    template <typename ValueType>
+    void addSection(vector<PendingSection>& sections, SectionKind kind, const FlatArray<ValueType>& array) {
+        addSection(sections, kind, array.data(), array.size());
+    }
+
+    /* Returns the offset rounded up to the next multiple of 8. */
+    uint64_t alignedOffset(uint64_t offset) {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+    /*
+     * Writes the header, the section table and the sections to a temporary file, then
+     * moves it over the file with the given name.
+     */
+    bool writeSections(const string& filename, int numNodes, int numEdges, const vector<PendingSection>& sections) {
+        IndexHeader header;
+        memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header.version = RoutingIndex::FORMAT_VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.nodeCount = numNodes;
+        header.edgeCount = numEdges;
+        header.sectionCount = sections.size();
+        header.reserved = 0;
+
+        vector<SectionEntry> entries;
+        uint64_t offset = sizeof(IndexHeader) + sections.size() * sizeof(SectionEntry);
+        for (const PendingSection& section : sections) {
+            offset = alignedOffset(offset);
+            entries.push_back({section.kind, section.elementSize, offset, section.count});
+            offset += section.count * section.elementSize;
+        }
+
+        string temporaryName = filename + ".tmp";
+        ofstream output(temporaryName.c_str(), ios::binary | ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SectionEntry));
+        uint64_t written = sizeof(IndexHeader) + entries.size() * sizeof(SectionEntry);
+        const char padding[8] = {};
+        for (size_t ii = 0; ii < sections.size(); ii++) {
+            output.write(padding, entries[ii].offset - written);
+            output.write(static_cast<const char*>(sections[ii].elements), sections[ii].count * sections[ii].elementSize);
+            written = entries[ii].offset + sections[ii].count * sections[ii].elementSize;
+        }
+        output.close();
+        if (output.fail()) {
+            remove(temporaryName.c_str());
+            return false;
+        }
+
+        // Renaming swaps in the new file at once, and leaves any mapping of the old one intact
+#if defined(_WIN32)
+        remove(filename.c_str());    // rename() does not replace existing files on Windows
+#endif
+        if (rename(temporaryName.c_str(), filename.c_str()) != 0) {
+            remove(temporaryName.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /*
+     * Returns whether every value lies in [low, high).
+     */
+    bool allInRange(const FlatArray<int>& values, int low, int high) {
+        for (int value : values) {
+            if (value < low or value >= high) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+     * Returns whether the array is a valid CSR offset array for numNodes nodes whose
+     * entries fill an array of the given length.
+     */
+    bool isOffsetArray(const FlatArray<int>& offsets, int numNodes, size_t length) {
+        if (offsets.size() != size_t(numNodes) + 1 or offsets[0] != 0 or size_t(offsets[numNodes]) != length) {
+            return false;
+        }
+        for (int node = 0; node < numNodes; node++) {
+            if (offsets[node] > offsets[node + 1]) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/*
+ * The section table of a mapped index file, whose entries are already known to lie
+ * inside the file.
+ */
+struct RoutingIndex::Sections {
+    const char* data;
+    const SectionEntry* entries;
+    uint32_t count;
+
+    /*
+     * Returns whether the file has a section of the given kind.
+     */
+    bool contains(uint32_t kind) const {
+        for (uint32_t ii = 0; ii < count; ii++) {
+            if (entries[ii].kind == kind) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+     * Points the array at the elements of the section of the given kind, without copying
+     * them.  Returns false if there is no such section or its elements have another size.
+     */
+    template <typename ValueType>
+    bool view(uint32_t kind, FlatArray<ValueType>& array) const {
+        for (uint32_t ii = 0; ii < count; ii++) {
+            if (entries[ii].kind == kind) {
+                if (entries[ii].elementSize != sizeof(ValueType)) {
+                    return false;
+                }
+                array = FlatArray<ValueType>::view(reinterpret_cast<const ValueType*>(data + entries[ii].offset),
+                                                   entries[ii].count);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+RoutingIndex::RoutingIndex(const RoadGraph& graph)
+    : graph(graph.compact()) {
+    // Everything else handled by default
+}
+
+/*
+ * Only the arrays that hold indices are checked value by value, since an index out of
+ * range would make a query read outside its tables; a damaged cost or distance merely
+ * gives a wrong answer.  The checks read those arrays once, which still costs far less
+ * than rebuilding them.
+ */
+bool RoutingIndex::load(const string& filename) {
+
+    unique_ptr<MappedFile> mapped(new MappedFile(filename));
+    if (!mapped->isOpen() or mapped->size() < sizeof(IndexHeader)) {
+        return false;
+    }
+
+    const IndexHeader* header = reinterpret_cast<const IndexHeader*>(mapped->data());
+    if (memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0
+            or header->version != FORMAT_VERSION
+            or header->byteOrder != BYTE_ORDER_MARK
+            or header->nodeCount != uint32_t(graph.nodeCount())
+            or header->edgeCount != uint32_t(graph.edgeCount())
+            or header->sectionCount > (mapped->size() - sizeof(IndexHeader)) / sizeof(SectionEntry)) {
+        return false;
+    }
+
+    Sections sections = {mapped->data(), reinterpret_cast<const SectionEntry*>(header + 1), header->sectionCount};
+    for (uint32_t ii = 0; ii < sections.count; ii++) {
+        const SectionEntry& entry = sections.entries[ii];
+        if (entry.elementSize == 0 or entry.offset % 8 != 0 or entry.offset > mapped->size()
+                or entry.count > (mapped->size() - entry.offset) / entry.elementSize) {
+            return false;
+        }
+    }
+
+    unique_ptr<ContractionHierarchy> loadedHierarchy;
+    unique_ptr<Landmarks> loadedLandmarks;
+    unique_ptr<ArcFlags> loadedFlags;
+    if (!matchesSnapshot(sections)
+            or !loadHierarchy(sections, loadedHierarchy)
+            or !loadLandmarks(sections, loadedLandmarks)
+            or !loadArcFlags(sections, loadedFlags)) {
+        return false;
+    }
+
+    hierarchy = move(loadedHierarchy);
+    landmarkTables = move(loadedLandmarks);
+    flags = move(loadedFlags);
+    file = move(mapped);
+    return true;
+}
+
+bool RoutingIndex::save(const string& filename) const {
+
+    int numNodes = graph.nodeCount();
+    int numEdges = graph.edgeCount();
+    vector<PendingSection> sections;
+
+    vector<int> offsets(numNodes + 1, numEdges);
+    vector<int> targets(numEdges);
+    vector<double> costs(numEdges);
+    vector<double> coordinates(2 * numNodes);
+    for (int node = 0; node < numNodes; node++) {
+        offsets[node] = graph.firstEdge(node);
+        coordinates[2 * node] = graph.nodeAt(node)->location().getX();
+        coordinates[2 * node + 1] = graph.nodeAt(node)->location().getY();
+    }
+    for (int edge = 0; edge < numEdges; edge++) {
+        targets[edge] = graph.edgeTarget(edge);
+        costs[edge] = graph.edgeCost(edge);
+    }
+    addSection(sections, SNAPSHOT_OFFSETS, offsets.data(), offsets.size());
+    addSection(sections, SNAPSHOT_TARGETS, targets.data(), targets.size());
+    addSection(sections, SNAPSHOT_COSTS, costs.data(), costs.size());
+    addSection(sections, SNAPSHOT_COORDINATES, coordinates.data(), coordinates.size());
+
+    int shortcutCount = hierarchy ? hierarchy->numShortcuts : 0;
+    if (hierarchy) {
+        addSection(sections, HIERARCHY_RANKS, hierarchy->ranks);
+        addSection(sections, HIERARCHY_ARCS, hierarchy->arcs);
+        addSection(sections, HIERARCHY_SHORTCUT_COUNT, &shortcutCount, 1);
+        addSection(sections, HIERARCHY_UPWARD_OFFSETS, hierarchy->upward.offsets);
+        addSection(sections, HIERARCHY_UPWARD_OTHERS, hierarchy->upward.others);
+        addSection(sections, HIERARCHY_UPWARD_COSTS, hierarchy->upward.costs);
+        addSection(sections, HIERARCHY_UPWARD_ARC_IDS, hierarchy->upward.arcIds);
+        addSection(sections, HIERARCHY_DOWNWARD_OFFSETS, hierarchy->downward.offsets);
+        addSection(sections, HIERARCHY_DOWNWARD_OTHERS, hierarchy->downward.others);
+        addSection(sections, HIERARCHY_DOWNWARD_COSTS, hierarchy->downward.costs);
+        addSection(sections, HIERARCHY_DOWNWARD_ARC_IDS, hierarchy->downward.arcIds);
+    }
+
+    if (landmarkTables) {
+        addSection(sections, LANDMARK_IDS, landmarkTables->landmarks);
+        addSection(sections, LANDMARK_FROM, landmarkTables->fromLandmark);
+        addSection(sections, LANDMARK_TO, landmarkTables->toLandmark);
+    }
+
+    int regionCount = flags ? flags->numRegions : 0;
+    if (flags) {
+        addSection(sections, ARC_FLAG_REGION_COUNT, &regionCount, 1);
+        addSection(sections, ARC_FLAG_REGIONS, flags->regions);
+        addSection(sections, ARC_FLAG_FLAGS, flags->flags);
+    }
+
+    return writeSections(filename, numNodes, numEdges, sections);
+}
+
+const ContractionHierarchy* RoutingIndex::contractionHierarchy() const {
+    return hierarchy.get();
+}
+
+const Landmarks* RoutingIndex::landmarks() const {
+    return landmarkTables.get();
+}
+
+const ArcFlags* RoutingIndex::arcFlags() const {
+    return flags.get();
+}
+
+void RoutingIndex::setContractionHierarchy(ContractionHierarchy* hierarchy) {
+    this->hierarchy.reset(hierarchy);
+}
+
+void RoutingIndex::setLandmarks(Landmarks* landmarks) {
+    landmarkTables.reset(landmarks);
+}
+
+void RoutingIndex::setArcFlags(ArcFlags* arcFlags) {
+    flags.reset(arcFlags);
+}
+
+bool RoutingIndex::matchesSnapshot(const Sections& sections) const {
+
+    int numNodes = graph.nodeCount();
+    int numEdges = graph.edgeCount();
+    FlatArray<int> offsets;
+    FlatArray<int> targets;
+    FlatArray<double> costs;
+    FlatArray<double> coordinates;
+    if (!sections.view(SNAPSHOT_OFFSETS, offsets) or offsets.size() != size_t(numNodes) + 1
+            or !sections.view(SNAPSHOT_TARGETS, targets) or targets.size() != size_t(numEdges)
+            or !sections.view(SNAPSHOT_COSTS, costs) or costs.size() != size_t(numEdges)
+            or !sections.view(SNAPSHOT_COORDINATES, coordinates) or coordinates.size() != 2 * size_t(numNodes)) {
+        return false;
+    }
+
+    for (int node = 0; node < numNodes; node++) {
+        Point location = graph.nodeAt(node)->location();
+        if (offsets[node] != graph.firstEdge(node)
+                or coordinates[2 * node] != location.getX()
+                or coordinates[2 * node + 1] != location.getY()) {
+            return false;
+        }
+    }
+    for (int edge = 0; edge < numEdges; edge++) {
+        if (targets[edge] != graph.edgeTarget(edge) or costs[edge] != graph.edgeCost(edge)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Shortcuts are always added after the two arcs they stand for, so an arc's children
+ * must come before it; that also rules out cycles that would make unpacking recurse forever.
+ */
+bool RoutingIndex::loadHierarchy(const Sections& sections, unique_ptr<ContractionHierarchy>& result) const {
+
+    if (!sections.contains(HIERARCHY_RANKS)) {
+        return true;
+    }
+
+    int numNodes = graph.nodeCount();
+    unique_ptr<ContractionHierarchy> candidate(new ContractionHierarchy(graph));
+    FlatArray<int> shortcutCount;
+    if (!sections.view(HIERARCHY_RANKS, candidate->ranks) or candidate->ranks.size() != size_t(numNodes)
+            or !sections.view(HIERARCHY_ARCS, candidate->arcs)
+            or !sections.view(HIERARCHY_SHORTCUT_COUNT, shortcutCount) or shortcutCount.size() != 1) {
+        return false;
+    }
+    candidate->numShortcuts = shortcutCount[0];
+
+    for (size_t ii = 0; ii < candidate->arcs.size(); ii++) {
+        const ContractionHierarchy::Arc& arc = candidate->arcs[ii];
+        bool isOriginal = arc.first == ContractionHierarchy::NO_ARC and arc.second == ContractionHierarchy::NO_ARC;
+        bool isShortcut = arc.first >= 0 and size_t(arc.first) < ii and arc.second >= 0 and size_t(arc.second) < ii;
+        if (arc.from < 0 or arc.from >= numNodes or arc.to < 0 or arc.to >= numNodes
+                or !(isOriginal or isShortcut)) {
+            return false;
+        }
+    }
+
+    auto viewArcList = [&](uint32_t firstKind, ContractionHierarchy::ArcList& arcList) {
+        return sections.view(firstKind, arcList.offsets)
+                and sections.view(firstKind + 1, arcList.others)
+                and sections.view(firstKind + 2, arcList.costs)
+                and sections.view(firstKind + 3, arcList.arcIds)
+                and isOffsetArray(arcList.offsets, numNodes, arcList.others.size())
+                and arcList.costs.size() == arcList.others.size()
+                and arcList.arcIds.size() == arcList.others.size()
+                and allInRange(arcList.others, 0, numNodes)
+                and allInRange(arcList.arcIds, 0, candidate->arcs.size());
+    };
+    if (!viewArcList(HIERARCHY_UPWARD_OFFSETS, candidate->upward)
+            or !viewArcList(HIERARCHY_DOWNWARD_OFFSETS, candidate->downward)) {
+        return false;
+    }
+
+    result = move(candidate);
+    return true;
+}
+
+bool RoutingIndex::loadLandmarks(const Sections& sections, unique_ptr<Landmarks>& result) const {
+
+    if (!sections.contains(LANDMARK_IDS)) {
+        return true;
+    }
+
+    int numNodes = graph.nodeCount();
+    unique_ptr<Landmarks> candidate(new Landmarks(graph));
+    if (!sections.view(LANDMARK_IDS, candidate->landmarks)
+            or !allInRange(candidate->landmarks, 0, numNodes)) {
+        return false;
+    }
+    size_t tableSize = size_t(numNodes) * candidate->landmarks.size();
+    if (!sections.view(LANDMARK_FROM, candidate->fromLandmark) or candidate->fromLandmark.size() != tableSize
+            or !sections.view(LANDMARK_TO, candidate->toLandmark) or candidate->toLandmark.size() != tableSize) {
+        return false;
+    }
+
+    result = move(candidate);
+    return true;
+}
+
+bool RoutingIndex::loadArcFlags(const Sections& sections, unique_ptr<ArcFlags>& result) const {
+
+    if (!sections.contains(ARC_FLAG_REGION_COUNT)) {
+        return true;
+    }
+
+    unique_ptr<ArcFlags> candidate(new ArcFlags(graph));
+    FlatArray<int> regionCount;
+    if (!sections.view(ARC_FLAG_REGION_COUNT, regionCount) or regionCount.size() != 1
+            or regionCount[0] < 1 or regionCount[0] > ArcFlags::MAX_REGIONS) {
+        return false;
+    }
+    candidate->numRegions = regionCount[0];
+
+    if (!sections.view(ARC_FLAG_REGIONS, candidate->regions)
+            or candidate->regions.size() != size_t(graph.nodeCount())
+            or !allInRange(candidate->regions, 0, candidate->numRegions)
+            or !sections.view(ARC_FLAG_FLAGS, candidate->flags)
+            or candidate->flags.size() != size_t(graph.edgeCount())) {
+        return false;
+    }
+
+    result = move(candidate);
+    return true;
+}
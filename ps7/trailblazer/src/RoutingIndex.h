@@ -0,0 +1,104 @@
+/*
+ * This header declares the RoutingIndex class, which keeps the preprocessed data built
+ * over one RoadGraph (a contraction hierarchy, landmark tables and arc flags) and saves
+ * it to disk, so that a program that restarts on the same map does not have to repeat
+ * the preprocessing.
+ *
+ * An index file holds a copy of the graph's CSR snapshot (topology, edge costs and node
+ * coordinates) followed by whichever of the three kinds of preprocessing were present
+ * when it was saved, each as flat arrays that start at a multiple of 8 bytes.  Loading
+ * maps the file into memory (see MappedFile.h) and points the tables of the loaded
+ * objects straight at the mapping (see FlatArray.h), so nothing is copied and pages are
+ * only read from disk as queries touch them.  A file is only accepted if its version and
+ * byte order match this program's and its snapshot matches the graph's exactly, so an
+ * index left over from an edited map or an older build is never used by mistake.
+ *
+ * The objects handed out by an index refer to the graph's CSR snapshot (and loaded ones
+ * to the mapping as well), so they stay valid only as long as both the index and the
+ * RoadGraph do.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "ArcFlags.h"
+#include "ContractionHierarchy.h"
+#include "Landmarks.h"
+#include "MappedFile.h"
+#include "RoadGraph.h"
+
+class RoutingIndex {
+public:
+    /* Version of the file format written by save(); files of other versions are rejected. */
+    static const int FORMAT_VERSION = 1;
+
+    /*
+     * Constructs an index over the given graph that holds no preprocessing yet.
+     */
+    explicit RoutingIndex(const RoadGraph& graph);
+
+    /*
+     * Replaces the contents of the index with the preprocessing stored in the file with
+     * the given name.  Returns false, leaving the index unchanged, if the file does not
+     * exist, is damaged, was written by another version, or was saved for a different
+     * graph (or the same graph with different edge costs).
+     */
+    bool load(const std::string& filename);
+
+    /*
+     * Writes the snapshot and every kind of preprocessing the index holds to the file
+     * with the given name.  The file is written under a temporary name and then renamed,
+     * so a reader never sees half of it, and an index loaded from the same file keeps
+     * working.  Returns false, leaving any old file in place, if it cannot be written.
+     */
+    bool save(const std::string& filename) const;
+
+    /*
+     * Returns the preprocessing of each kind held by the index, or nullptr if it holds
+     * none of that kind.
+     */
+    const ContractionHierarchy* contractionHierarchy() const;
+    const Landmarks* landmarks() const;
+    const ArcFlags* arcFlags() const;
+
+    /*
+     * Stores the given preprocessing in the index, which takes ownership of it and frees
+     * any it held of the same kind.  It must have been built over the index's graph.
+     */
+    void setContractionHierarchy(ContractionHierarchy* hierarchy);
+    void setLandmarks(Landmarks* landmarks);
+    void setArcFlags(ArcFlags* arcFlags);
+
+private:
+    const CompactRoadGraph& graph;
+
+    /* The mapping must outlive the objects whose tables view it, so it is declared (and
+     * therefore destroyed) before them.
+     */
+    std::unique_ptr<MappedFile> file;
+    std::unique_ptr<ContractionHierarchy> hierarchy;
+    std::unique_ptr<Landmarks> landmarkTables;
+    std::unique_ptr<ArcFlags> flags;
+
+    /* The section table of a file being loaded (see RoutingIndex.cpp). */
+    struct Sections;
+
+    /*
+     * Returns whether the snapshot stored in the file matches the graph's.
+     */
+    bool matchesSnapshot(const Sections& sections) const;
+
+    /*
+     * Points a new object's tables at the file's sections of each kind of preprocessing
+     * and stores it in result, or leaves result empty if the file holds none of that kind.
+     * Returns false if the sections are damaged.
+     */
+    bool loadHierarchy(const Sections& sections, std::unique_ptr<ContractionHierarchy>& result) const;
+    bool loadLandmarks(const Sections& sections, std::unique_ptr<Landmarks>& result) const;
+    bool loadArcFlags(const Sections& sections, std::unique_ptr<ArcFlags>& result) const;
+
+    /* An index owns its preprocessing, so it cannot be copied. */
+    RoutingIndex(const RoutingIndex&) = delete;
+    RoutingIndex& operator=(const RoutingIndex&) = delete;
+};
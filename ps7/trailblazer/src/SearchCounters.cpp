@@ -0,0 +1,63 @@
+/*
+ * This sourcecode file implements the SearchCounters and SearchTimer classes declared in
+ * SearchCounters.h.
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "SearchCounters.h"
+using namespace std;
+
+void SearchCounters::add(const SearchCounters& other) {
+    queries += other.queries;
+    settled += other.settled;
+    fringe += other.fringe;
+    relaxed += other.relaxed;
+    pushes += other.pushes;
+    pops += other.pops;
+    decreaseKeys += other.decreaseKeys;
+    peakOpenSet = max(peakOpenSet, other.peakOpenSet);
+    elapsedMs += other.elapsedMs;
+}
+
+string SearchCounters::toJson() const {
+    ostringstream out;
+    out << "{\"queries\": " << queries
+        << ", \"settled\": " << settled
+        << ", \"fringe\": " << fringe
+        << ", \"relaxed\": " << relaxed
+        << ", \"pushes\": " << pushes
+        << ", \"pops\": " << pops
+        << ", \"decreaseKeys\": " << decreaseKeys
+        << ", \"peakOpenSet\": " << peakOpenSet
+        << ", \"elapsedMs\": " << elapsedMs << "}";
+    return out.str();
+}
+
+string SearchCounters::toCsv() const {
+    ostringstream out;
+    out << queries << "," << settled << "," << fringe << "," << relaxed << ","
+        << pushes << "," << pops << "," << decreaseKeys << "," << peakOpenSet << ","
+        << elapsedMs;
+    return out.str();
+}
+
+string SearchCounters::csvHeader() {
+    return "queries,settled,fringe,relaxed,pushes,pops,decreaseKeys,peakOpenSet,elapsedMs";
+}
+
+SearchTimer::SearchTimer(SearchCounters* counters)
+    : counters(counters) {
+
+    if (counters != nullptr) {
+        startTime = chrono::steady_clock::now();
+    }
+}
+
+SearchTimer::~SearchTimer() {
+    if (counters != nullptr) {
+        counters->queries++;
+        counters->elapsedMs += chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * This header declares SearchCounters, a lightweight record of the work done by the path
+ * searches, and SearchTimer, which adds the wall time of one search to it.
+ *
+ * A search reports to the counters in SearchOptions::counters, if there are any: every
+ * node it settles or adds to its fringe, every edge it examines, every operation on its
+ * open set and the time it took.  Counters that are reset before each query therefore
+ * hold a per-query record, and counters that are not keep totals over many queries.
+ * Either way they can be written out as JSON or as a CSV row, for comparing algorithms
+ * on a map or spotting regressions between versions.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+/*
+ * Running totals of the work done by the searches that were given these counters.  The
+ * searches only ever add to them (peakOpenSet excepted, which only grows), so one set of
+ * counters can total several searches.
+ */
+struct SearchCounters {
+    long long queries = 0;        // searches that reported here (each one timed once)
+    long long settled = 0;        // nodes whose shortest distance was finalized (colored green)
+    long long fringe = 0;         // nodes added to the fringe, or moved up in it (colored yellow)
+    long long relaxed = 0;        // edges examined out of settled nodes
+    long long pushes = 0;         // IDs added to an open set (heap or queue)
+    long long pops = 0;           // IDs removed from an open set
+    long long decreaseKeys = 0;   // priorities lowered in place in a heap
+    long long peakOpenSet = 0;    // the most IDs any one open set held at once
+    double elapsedMs = 0.0;       // total wall time of the searches, in milliseconds
+
+    /*
+     * Adds the other counters' totals to these, taking the larger peakOpenSet.
+     */
+    void add(const SearchCounters& other);
+
+    /*
+     * Returns the counters as a single-line JSON object whose keys are the field names.
+     */
+    std::string toJson() const;
+
+    /*
+     * Returns the counters as one CSV row, in the column order given by csvHeader(),
+     * which returns the matching header row.  Neither ends with a newline.
+     */
+    std::string toCsv() const;
+    static std::string csvHeader();
+};
+
+/*
+ * Measures the wall time from its construction to its destruction and adds it, along with
+ * one query, to the given counters.  Nothing is measured if the counters are null.  The
+ * searches create one at the top of the function that does the work, so that the wrappers
+ * calling it do not count the same query twice.
+ */
+class SearchTimer {
+public:
+    explicit SearchTimer(SearchCounters* counters);
+    ~SearchTimer();
+
+private:
+    SearchCounters* counters;
+    std::chrono::steady_clock::time_point startTime;
+
+    /* A timer reports exactly once, so it cannot be copied. */
+    SearchTimer(const SearchTimer&) = delete;
+    SearchTimer& operator=(const SearchTimer&) = delete;
+};
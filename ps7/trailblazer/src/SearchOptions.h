@@ -0,0 +1,57 @@
+/*
+ * This header declares the SearchOptions structure, which carries optional settings for
+ * the path-searching algorithms declared in Trailblazer.h.  The default-constructed
+ * options reproduce the behavior of the searches that take no options.
+ *
+ * It also declares the helpers the searches use to report each node they touch, and the
+ * edges they examine, to the display and to SearchCounters (see SearchCounters.h).
+ */
+
+#pragma once
+
+#include "IndexedHeap.h"
+#include "RoadGraph.h"
+#include "SearchCounters.h"
+
+class ArcFlags;
+class Landmarks;
+
+struct SearchOptions {
+    int heapArity = IndexedHeap::DEFAULT_ARITY;   // arity of the open-set heap used by Dijkstra / A*
+    const Landmarks* landmarks = nullptr;         // ALT lower bounds for A* (see Landmarks.h); crow-fly if null
+    const ArcFlags* arcFlags = nullptr;           // edge pruning for Dijkstra / A* toward the end's region (see ArcFlags.h)
+    bool headless = false;                        // skip coloring nodes, and with it all observer notifications
+    SearchCounters* counters = nullptr;           // where to count the work done, if anywhere
+};
+
+/*
+ * Reports that a search settled the given node, or added it to its fringe: the node is
+ * colored in the display unless the search is headless, and counted if there are counters.
+ * Every color change notifies the node's observers, which is what headless searches avoid.
+ */
+inline void reportSettled(RoadNode* node, const SearchOptions& options) {
+    if (options.counters != nullptr) {
+        options.counters->settled++;
+    }
+    if (!options.headless) {
+        node->setColor(Color::GREEN);
+    }
+}
+
+inline void reportFringe(RoadNode* node, const SearchOptions& options) {
+    if (options.counters != nullptr) {
+        options.counters->fringe++;
+    }
+    if (!options.headless) {
+        node->setColor(Color::YELLOW);
+    }
+}
+
+/*
+ * Reports that a search examined the given number of edges out of a node it settled.
+ */
+inline void reportRelaxed(int numEdges, const SearchOptions& options) {
+    if (options.counters != nullptr) {
+        options.counters->relaxed += numEdges;
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * This sourcecode file implements the SearchSpace class declared in SearchSpace.h.
+ */
+
+#include <climits>
+#include <memory>
+
+#include "SearchSpace.h"
+using namespace std;
+
+/* Number of reusable search spaces kept per thread. */
+static const int NUM_REUSABLE_SLOTS = 4;
+
+SearchSpace::SearchSpace(const CompactRoadGraph& graph)
+    : graph(graph),
+      epoch(1),
+      distances(graph.nodeCount(), DBL_MAX),
+      parents(graph.nodeCount(), NO_PARENT),
+      reachedEpoch(graph.nodeCount(), 0),
+      visitedEpoch(graph.nodeCount(), 0),
+      potentials(graph.nodeCount(), 0.0),
+      potentialEpoch(graph.nodeCount(), 0) {
+    // Everything else handled by default
+}
+
+SearchSpace& SearchSpace::reusable(const CompactRoadGraph& graph, int slot) {
+
+    static thread_local unique_ptr<SearchSpace> spaces[NUM_REUSABLE_SLOTS];
+    unique_ptr<SearchSpace>& space = spaces[slot];
+
+    // A space left over from a different graph has tables of the wrong shape, so rebuild it
+    if (!space or &space->graph != &graph or space->size() != graph.nodeCount()) {
+        space.reset(new SearchSpace(graph));
+    }
+    else {
+        space->clear();
+    }
+
+    return *space;
+}
+
+int SearchSpace::idOf(RoadNode* node) const {
+    return graph.indexOf(node);
+}
+
+RoadNode* SearchSpace::nodeAt(int id) const {
+    return graph.nodeAt(id);
+}
+
+int SearchSpace::size() const {
+    return graph.nodeCount();
+}
+
+Path SearchSpace::pathTo(int id) const {
+
+    // Counting the nodes first so that the path can be filled in from the back
+    int length = 0;
+    for (int curr = id; curr != NO_PARENT; curr = parentOf(curr)) {
+        length++;
+    }
+
+    Path path(length, nullptr);
+    for (int curr = id; curr != NO_PARENT; curr = parentOf(curr)) {
+        path[--length] = graph.nodeAt(curr);
+    }
+
+    return path;
+}
+
+void SearchSpace::clear() {
+
+    if (epoch < INT_MAX) {
+        epoch++;
+        return;
+    }
+
+    // The stamps are about to wrap around, so this one time the tables really are wiped
+    fill(reachedEpoch.begin(), reachedEpoch.end(), 0);
+    fill(visitedEpoch.begin(), visitedEpoch.end(), 0);
+    fill(potentialEpoch.begin(), potentialEpoch.end(), 0);
+    epoch = 1;
+}
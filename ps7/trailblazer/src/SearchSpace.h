@@ -0,0 +1,153 @@
+/*
+ * This header declares the SearchSpace class, which holds the per-node bookkeeping
+ * shared by the trailblazing algorithms.  Instead of storing a complete Path in the
+ * queue for every relaxed edge, the search records each node's best known distance and
+ * predecessor in flat tables indexed by the node's dense ID in a CompactRoadGraph.
+ * The final Path is rebuilt once, from the predecessor chain, when the search finishes.
+ *
+ * Entries are stamped with the epoch (search number) that wrote them, and entries from
+ * older epochs read as unreached / unvisited.  Starting a new search therefore only
+ * bumps the epoch instead of clearing every table, so one SearchSpace can be reused
+ * across many queries on the same graph (see SearchSpace::reusable()).
+ */
+
+#pragma once
+
+#include <cfloat>
+#include <vector>
+#include "CompactRoadGraph.h"
+#include "Trailblazer.h"
+
+class SearchSpace {
+public:
+    /* Value used for the predecessor of a node that has none (e.g. the start node). */
+    static const int NO_PARENT = -1;
+
+    /*
+     * Constructs a search space over every node of the given graph, with each node at
+     * an infinite distance and without a predecessor.
+     */
+    explicit SearchSpace(const CompactRoadGraph& graph);
+
+    /*
+     * Returns a search space for the given graph that is owned by the calling thread and
+     * reused by later calls, already cleared for a new search.  Searches that need more
+     * than one space at a time (e.g. one per search direction) ask for different slots.
+     */
+    static SearchSpace& reusable(const CompactRoadGraph& graph, int slot = 0);
+
+    /*
+     * Returns the dense ID of the given node.
+     */
+    int idOf(RoadNode* node) const;
+
+    /*
+     * Returns the node that was assigned the given ID.
+     */
+    RoadNode* nodeAt(int id) const;
+
+    /*
+     * Returns the number of nodes in the search space.
+     */
+    int size() const;
+
+    /*
+     * Returns the best known distance to the node, or infinity if it was never reached.
+     */
+    double distanceTo(int id) const;
+
+    /*
+     * Returns the ID of the node's predecessor on its best known path, or NO_PARENT.
+     */
+    int parentOf(int id) const;
+
+    /*
+     * Records a new best known distance and predecessor for the node.
+     */
+    void relax(int id, int parent, double distance);
+
+    /*
+     * Returns whether the node has been marked as visited (settled) by the search.
+     */
+    bool isVisited(int id) const;
+
+    /*
+     * Marks the node as visited (settled) by the search.
+     */
+    void markVisited(int id);
+
+    /*
+     * Returns whether a potential (the A* estimate of the cost still to go) has been
+     * stored for the node in the current search, and the stored value.  The potential of
+     * a node does not change during a search, so A* computes it the first time the node
+     * is reached and reads it back whenever a cheaper route to the node is found.
+     */
+    bool hasPotential(int id) const;
+    double potentialOf(int id) const;
+
+    /*
+     * Stores the node's potential for the rest of the current search.
+     */
+    void setPotential(int id, double potential);
+
+    /*
+     * Rebuilds the path from the search's root to the given node by walking the
+     * predecessor chain backward.
+     */
+    Path pathTo(int id) const;
+
+    /*
+     * Resets every node so that the space can be reused for a new search. This takes
+     * constant time except on the rare occasions when the epoch counter wraps around.
+     */
+    void clear();
+
+private:
+    const CompactRoadGraph& graph;   // graph whose dense IDs index the tables
+    int epoch;                       // stamp of the current search
+    std::vector<double> distances;   // best known distance per ID
+    std::vector<int> parents;        // predecessor ID per ID
+    std::vector<int> reachedEpoch;   // epoch in which distances / parents were last written
+    std::vector<int> visitedEpoch;   // epoch in which the ID was last settled
+    std::vector<double> potentials;  // A* potential per ID
+    std::vector<int> potentialEpoch; // epoch in which potentials was last written
+};
+
+/*
+ * The table accessors are called once per relaxed edge, so they are defined here where
+ * the compiler can inline them.
+ */
+inline double SearchSpace::distanceTo(int id) const {
+    return reachedEpoch[id] == epoch ? distances[id] : DBL_MAX;
+}
+
+inline int SearchSpace::parentOf(int id) const {
+    return reachedEpoch[id] == epoch ? parents[id] : NO_PARENT;
+}
+
+inline void SearchSpace::relax(int id, int parent, double distance) {
+    distances[id] = distance;
+    parents[id] = parent;
+    reachedEpoch[id] = epoch;
+}
+
+inline bool SearchSpace::isVisited(int id) const {
+    return visitedEpoch[id] == epoch;
+}
+
+inline void SearchSpace::markVisited(int id) {
+    visitedEpoch[id] = epoch;
+}
+
+inline bool SearchSpace::hasPotential(int id) const {
+    return potentialEpoch[id] == epoch;
+}
+
+inline double SearchSpace::potentialOf(int id) const {
+    return potentials[id];
+}
+
+inline void SearchSpace::setPotential(int id, double potential) {
+    potentials[id] = potential;
+    potentialEpoch[id] = epoch;
+}
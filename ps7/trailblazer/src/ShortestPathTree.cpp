@@ -0,0 +1,204 @@
+/*
+ * This sourcecode file implements the one-to-all and many-to-many searches declared in
+ * ShortestPathTree.h.
+ */
+
+#include <cfloat>
+
+#include "error.h"
+#include "IndexedHeap.h"
+#include "SearchSpace.h"
+#include "ShortestPathTree.h"
+using namespace std;
+
+/* Private helper functions only needed in this file. */
+namespace {
+    /*
+     * Returns the dense ID of the node, reporting an error if it is not in the graph.
+     */
+    int requireId(const CompactRoadGraph& compact, RoadNode* node) {
+        int id = compact.indexOf(node);
+        if (id == CompactRoadGraph::NO_NODE) {
+            error("The node is not part of this graph");
+        }
+        return id;
+    }
+
+    /*
+     * Runs Dijkstra's algorithm from rootId, over outgoing edges (forward) or incoming
+     * edges (backward), in the calling thread's reusable search space.  The search settles
+     * everything reachable, unless isStopNode is given: then it stops once numStopNodes
+     * distinct nodes marked in isStopNode have been settled.
+     */
+    SearchSpace& runSearch(const CompactRoadGraph& compact, int rootId, bool forward,
+                           const vector<char>* isStopNode, int numStopNodes, const SearchOptions& options) {
+
+        SearchSpace& space = SearchSpace::reusable(compact);
+        IndexedHeap& openSet = IndexedHeap::reusable(compact.nodeCount(), options.heapArity);
+        openSet.countInto(options.counters);
+        space.relax(rootId, SearchSpace::NO_PARENT, 0.0);
+        openSet.enqueue(rootId, 0.0);
+
+        while (!openSet.isEmpty()) {
+
+            int nodeId = openSet.dequeue();
+            space.markVisited(nodeId);
+            reportSettled(compact.nodeAt(nodeId), options);
+
+            if (isStopNode != nullptr and (*isStopNode)[nodeId] and --numStopNodes == 0) {
+                break;
+            }
+
+            double currCost = space.distanceTo(nodeId);
+            int firstEdge = forward ? compact.firstEdge(nodeId) : compact.firstInEdge(nodeId);
+            int endEdge = forward ? compact.endEdge(nodeId) : compact.endInEdge(nodeId);
+            reportRelaxed(endEdge - firstEdge, options);
+
+            for (int edge = firstEdge; edge < endEdge; edge++) {
+                int neighborId = forward ? compact.edgeTarget(edge) : compact.inEdgeSource(edge);
+                if (space.isVisited(neighborId)) {
+                    continue;
+                }
+                double updatedCost = currCost + (forward ? compact.edgeCost(edge) : compact.inEdgeCost(edge));
+                if (updatedCost < space.distanceTo(neighborId)) {
+                    space.relax(neighborId, nodeId, updatedCost);
+                    openSet.enqueueOrDecrease(neighborId, updatedCost);
+                    reportFringe(compact.nodeAt(neighborId), options);
+                }
+            }
+        }
+
+        return space;
+    }
+}
+
+ShortestPathTree::ShortestPathTree(const RoadGraph& graph, RoadNode* root, bool reversed,
+                                   const SearchOptions& options)
+    : graph(&graph.compact()),
+      rootId(requireId(graph.compact(), root)),
+      reversed(reversed) {
+
+    SearchTimer timer(options.counters);
+    const SearchSpace& space = runSearch(*this->graph, rootId, !reversed, nullptr, 0, options);
+
+    int numNodes = this->graph->nodeCount();
+    distanceTable.resize(numNodes);
+    parentTable.resize(numNodes);
+    for (int id = 0; id < numNodes; id++) {
+        distanceTable[id] = space.distanceTo(id);
+        parentTable[id] = space.parentOf(id);
+    }
+}
+
+RoadNode* ShortestPathTree::root() const {
+    return graph->nodeAt(rootId);
+}
+
+bool ShortestPathTree::isReversed() const {
+    return reversed;
+}
+
+bool ShortestPathTree::reaches(RoadNode* node) const {
+    return distanceTo(node) != DBL_MAX;
+}
+
+double ShortestPathTree::distanceTo(RoadNode* node) const {
+    int id = graph->indexOf(node);
+    return id == CompactRoadGraph::NO_NODE ? DBL_MAX : distanceTable[id];
+}
+
+RoadNode* ShortestPathTree::parentOf(RoadNode* node) const {
+    int id = graph->indexOf(node);
+    if (id == CompactRoadGraph::NO_NODE or parentTable[id] == NO_PARENT) {
+        return nullptr;
+    }
+    return graph->nodeAt(parentTable[id]);
+}
+
+/*
+ * The predecessor chain runs from the node back to the root, which is travel order in a
+ * reversed tree and the opposite of it in a forward one.
+ */
+Path ShortestPathTree::pathTo(RoadNode* node) const {
+
+    if (!reaches(node)) {
+        return {};
+    }
+
+    Path path;
+    for (int curr = graph->indexOf(node); curr != NO_PARENT; curr = parentTable[curr]) {
+        path.add(graph->nodeAt(curr));
+    }
+    if (!reversed) {
+        for (int ii = 0, jj = path.size() - 1; ii < jj; ii++, jj--) {
+            swap(path[ii], path[jj]);
+        }
+    }
+    return path;
+}
+
+const CompactRoadGraph& ShortestPathTree::compactGraph() const {
+    return *graph;
+}
+
+const vector<double>& ShortestPathTree::distances() const {
+    return distanceTable;
+}
+
+const vector<int>& ShortestPathTree::parents() const {
+    return parentTable;
+}
+
+ShortestPathTree oneToAll(const RoadGraph& graph, RoadNode* source, const SearchOptions& options) {
+    return ShortestPathTree(graph, source, false, options);
+}
+
+ShortestPathTree allToOne(const RoadGraph& graph, RoadNode* target, const SearchOptions& options) {
+    return ShortestPathTree(graph, target, true, options);
+}
+
+/*
+ * Searching from the shorter list keeps the number of searches at min(N, M).  Searches
+ * from the targets run backward, so either way entry [i][j] is the cost from source i to
+ * target j.
+ */
+Grid<double> distanceMatrix(const RoadGraph& graph, const Vector<RoadNode*>& sources,
+                            const Vector<RoadNode*>& targets, const SearchOptions& options) {
+
+    SearchTimer timer(options.counters);
+    const CompactRoadGraph& compact = graph.compact();
+    Grid<double> matrix(sources.size(), targets.size(), DBL_MAX);
+
+    bool forward = sources.size() <= targets.size();
+    const Vector<RoadNode*>& roots = forward ? sources : targets;
+    const Vector<RoadNode*>& others = forward ? targets : sources;
+
+    vector<int> otherIds;
+    vector<char> isStopNode(compact.nodeCount(), false);
+    int numStopNodes = 0;
+    for (RoadNode* node : others) {
+        int id = requireId(compact, node);
+        otherIds.push_back(id);
+        if (!isStopNode[id]) {
+            isStopNode[id] = true;
+            numStopNodes++;
+        }
+    }
+
+    for (int ii = 0; ii < roots.size(); ii++) {
+        int rootId = requireId(compact, roots[ii]);
+        const SearchSpace& space = runSearch(compact, rootId, forward, &isStopNode, numStopNodes, options);
+
+        for (int jj = 0; jj < others.size(); jj++) {
+            double distance = space.distanceTo(otherIds[jj]);
+            if (forward) {
+                matrix[ii][jj] = distance;
+            }
+            else {
+                matrix[jj][ii] = distance;
+            }
+        }
+    }
+
+    return matrix;
+}
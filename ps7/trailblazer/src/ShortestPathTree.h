@@ -0,0 +1,115 @@
+/*
+ * This header declares searches that find shortest paths from one node to every other
+ * node, or between every pair of nodes from two lists, instead of between one start and
+ * one end.
+ *
+ * oneToAll() runs Dijkstra's algorithm from a source until the whole graph reachable from
+ * it is settled, and returns the resulting ShortestPathTree: the cost of the cheapest path
+ * to every node together with the predecessor table that rebuilds those paths.  allToOne()
+ * does the same over reversed edges, giving every node's cheapest path to a target.
+ *
+ * distanceMatrix() fills in an N x M table of travel costs between N sources and M
+ * targets.  It runs one search from each node on the shorter of the two lists, in the
+ * matching direction, and each search stops as soon as every node on the other list is
+ * settled.  With a ContractionHierarchy, ContractionHierarchy::distanceMatrix() computes
+ * the same table much faster.
+ */
+
+#pragma once
+
+#include <vector>
+#include "grid.h"
+#include "vector.h"
+#include "CompactRoadGraph.h"
+#include "RoadGraph.h"
+#include "SearchOptions.h"
+#include "Trailblazer.h"
+
+class ShortestPathTree {
+public:
+    /* Value used for the predecessor of a node that has none (e.g. the root). */
+    static const int NO_PARENT = -1;
+
+    /*
+     * Returns the node the tree was grown from: the source of a forward tree, or the
+     * target of a reversed one.
+     */
+    RoadNode* root() const;
+
+    /*
+     * Returns whether the tree holds paths to its root (from allToOne()) rather than paths
+     * from it (from oneToAll()).
+     */
+    bool isReversed() const;
+
+    /*
+     * Returns whether there is a path between the root and the given node.
+     */
+    bool reaches(RoadNode* node) const;
+
+    /*
+     * Returns the cost of the cheapest path from the root to the node (or from the node
+     * to the root, in a reversed tree), or DBL_MAX if there is none.
+     */
+    double distanceTo(RoadNode* node) const;
+
+    /*
+     * Returns the node before the given one on its path from the root (or after it on its
+     * path to the root, in a reversed tree), or nullptr for the root and unreached nodes.
+     */
+    RoadNode* parentOf(RoadNode* node) const;
+
+    /*
+     * Returns the cheapest path between the root and the node, in travel order: from the
+     * root to the node, or from the node to the root in a reversed tree.  The path is
+     * empty if the node is not reached.
+     */
+    Path pathTo(RoadNode* node) const;
+
+    /*
+     * Returns the CSR snapshot whose dense node IDs index the tables below.
+     */
+    const CompactRoadGraph& compactGraph() const;
+
+    /*
+     * Returns the whole distance / predecessor tables, indexed by dense node ID.  Unreached
+     * nodes have a distance of DBL_MAX and a parent of NO_PARENT.
+     */
+    const std::vector<double>& distances() const;
+    const std::vector<int>& parents() const;
+
+private:
+    const CompactRoadGraph* graph;
+    int rootId;
+    bool reversed;
+    std::vector<double> distanceTable;
+    std::vector<int> parentTable;
+
+    /*
+     * Runs the search that oneToAll() / allToOne() describe and stores its tables.
+     */
+    ShortestPathTree(const RoadGraph& graph, RoadNode* root, bool reversed, const SearchOptions& options);
+
+    friend ShortestPathTree oneToAll(const RoadGraph& graph, RoadNode* source, const SearchOptions& options);
+    friend ShortestPathTree allToOne(const RoadGraph& graph, RoadNode* target, const SearchOptions& options);
+};
+
+/*
+ * Returns the tree of cheapest paths from the source to every node.
+ */
+ShortestPathTree oneToAll(const RoadGraph& graph, RoadNode* source,
+                          const SearchOptions& options = SearchOptions());
+
+/*
+ * Returns the tree of cheapest paths from every node to the target.
+ */
+ShortestPathTree allToOne(const RoadGraph& graph, RoadNode* target,
+                          const SearchOptions& options = SearchOptions());
+
+/*
+ * Returns the cost of the cheapest path from every source to every target, with the
+ * sources as rows and the targets as columns.  Unreachable pairs hold DBL_MAX.
+ */
+Grid<double> distanceMatrix(const RoadGraph& graph, const Vector<RoadNode*>& sources,
+                            const Vector<RoadNode*>& targets,
+                            const SearchOptions& options = SearchOptions());
@@ -0,0 +1,189 @@
+/*
+ * This sourcecode file implements the SpatialIndex class declared in SpatialIndex.h.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "SpatialIndex.h"
+using namespace std;
+
+/* Private constants only needed in this file. */
+namespace {
+    /* The grid is sized so that its cells hold about this many nodes each. */
+    const int NODES_PER_CELL = 2;
+}
+
+SpatialIndex::SpatialIndex(const Graph<RoadNode, RoadEdge>& graph)
+    : minX(0.0),
+      minY(0.0),
+      cellSize(1.0),
+      columns(1),
+      rows(1) {
+
+    vector<RoadNode*> unsorted;
+    for (RoadNode* node : graph) {
+        unsorted.push_back(node);
+    }
+    if (unsorted.empty()) {
+        cellStart.assign(2, 0);
+        return;
+    }
+
+    double maxX = minX = unsorted[0]->location().getX();
+    double maxY = minY = unsorted[0]->location().getY();
+    for (RoadNode* node : unsorted) {
+        minX = min(minX, node->location().getX());
+        maxX = max(maxX, node->location().getX());
+        minY = min(minY, node->location().getY());
+        maxY = max(maxY, node->location().getY());
+    }
+
+    // Square cells covering the bounding box; a box with no height or width is a line
+    double width = maxX - minX;
+    double height = maxY - minY;
+    double numCells = max(1.0, double(unsorted.size() / NODES_PER_CELL));
+    if (width > 0 and height > 0) {
+        cellSize = sqrt(width * height / numCells);
+    }
+    else if (width > 0 or height > 0) {
+        cellSize = max(width, height) / numCells;
+    }
+    columns = int(width / cellSize) + 1;
+    rows = int(height / cellSize) + 1;
+
+    // Counting sort of the nodes by cell
+    vector<int> cells;
+    cells.reserve(unsorted.size());
+    cellStart.assign(size_t(columns) * rows + 1, 0);
+    for (RoadNode* node : unsorted) {
+        int cell = rowOf(node->location().getY()) * columns + columnOf(node->location().getX());
+        cells.push_back(cell);
+        cellStart[cell + 1]++;
+    }
+    for (size_t cell = 1; cell < cellStart.size(); cell++) {
+        cellStart[cell] += cellStart[cell - 1];
+    }
+
+    xs.resize(unsorted.size());
+    ys.resize(unsorted.size());
+    nodes.resize(unsorted.size());
+    vector<int> nextSlot(cellStart.begin(), cellStart.end() - 1);
+    for (size_t ii = 0; ii < unsorted.size(); ii++) {
+        int slot = nextSlot[cells[ii]]++;
+        xs[slot] = unsorted[ii]->location().getX();
+        ys[slot] = unsorted[ii]->location().getY();
+        nodes[slot] = unsorted[ii];
+    }
+}
+
+int SpatialIndex::size() const {
+    return nodes.size();
+}
+
+/*
+ * Ring r is the set of cells whose column and row are both within r of the point's cell,
+ * with one of them exactly r away.  A node in ring r or beyond is at least (r - 1) cell
+ * sizes from the point, even when the point lies outside the grid, so the search stops at
+ * the first ring that cannot hold anything nearer than the best node so far.
+ */
+RoadNode* SpatialIndex::nearest(double x, double y, double maxDistance) const {
+
+    int column = columnOf(x);
+    int row = rowOf(y);
+    RoadNode* best = nullptr;
+    double bestSquared = maxDistance < DBL_MAX ? maxDistance * maxDistance : DBL_MAX;
+
+    auto searchCell = [&](int cellColumn, int cellRow) {
+        int cell = cellRow * columns + cellColumn;
+        for (int slot = cellStart[cell]; slot < cellStart[cell + 1]; slot++) {
+            double dx = xs[slot] - x;
+            double dy = ys[slot] - y;
+            double squared = dx * dx + dy * dy;
+            if (squared < bestSquared or (best == nullptr and squared == bestSquared)) {
+                best = nodes[slot];
+                bestSquared = squared;
+            }
+        }
+    };
+
+    int lastRing = max(columns, rows);
+    for (int ring = 0; ring <= lastRing; ring++) {
+        double reach = max(0, ring - 1) * cellSize;
+        if (reach * reach > bestSquared) {
+            break;
+        }
+
+        for (int cellRow = max(0, row - ring); cellRow <= min(rows - 1, row + ring); cellRow++) {
+            if (abs(cellRow - row) == ring) {
+                // The top and bottom of the ring are whole rows of cells
+                for (int cellColumn = max(0, column - ring); cellColumn <= min(columns - 1, column + ring); cellColumn++) {
+                    searchCell(cellColumn, cellRow);
+                }
+            }
+            else {
+                if (column - ring >= 0) {
+                    searchCell(column - ring, cellRow);
+                }
+                if (ring > 0 and column + ring < columns) {
+                    searchCell(column + ring, cellRow);
+                }
+            }
+        }
+    }
+    return best;
+}
+
+Vector<RoadNode*> SpatialIndex::withinRadius(double x, double y, double radius) const {
+
+    vector<pair<double, RoadNode*>> found;
+    double radiusSquared = radius * radius;
+    if (radius >= 0) {
+        for (int cellRow = rowOf(y - radius); cellRow <= rowOf(y + radius); cellRow++) {
+            int firstCell = cellRow * columns + columnOf(x - radius);
+            int lastCell = cellRow * columns + columnOf(x + radius);
+            // The cells of one row are next to each other, so their nodes are too
+            for (int slot = cellStart[firstCell]; slot < cellStart[lastCell + 1]; slot++) {
+                double dx = xs[slot] - x;
+                double dy = ys[slot] - y;
+                if (dx * dx + dy * dy <= radiusSquared) {
+                    found.push_back({dx * dx + dy * dy, nodes[slot]});
+                }
+            }
+        }
+    }
+
+    sort(found.begin(), found.end(), [](const pair<double, RoadNode*>& a, const pair<double, RoadNode*>& b) {
+        return a.first < b.first;
+    });
+    Vector<RoadNode*> result;
+    for (const pair<double, RoadNode*>& entry : found) {
+        result.add(entry.second);
+    }
+    return result;
+}
+
+Vector<RoadNode*> SpatialIndex::nearestToEach(const Vector<Point>& points, double maxDistance) const {
+    Vector<RoadNode*> result;
+    for (const Point& point : points) {
+        result.add(nearest(point.getX(), point.getY(), maxDistance));
+    }
+    return result;
+}
+
+int SpatialIndex::columnOf(double x) const {
+    double column = floor((x - minX) / cellSize);
+    if (!(column > 0)) {
+        return 0;
+    }
+    return column >= columns ? columns - 1 : int(column);
+}
+
+int SpatialIndex::rowOf(double y) const {
+    double row = floor((y - minY) / cellSize);
+    if (!(row > 0)) {
+        return 0;
+    }
+    return row >= rows ? rows - 1 : int(row);
+}
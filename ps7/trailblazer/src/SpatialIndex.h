@@ -0,0 +1,78 @@
+/*
+ * This header declares the SpatialIndex class, which finds the nodes of a map near a given
+ * point: the node that was clicked on, or the node to snap a GPS position to.
+ *
+ * The nodes are bucketed by their location() into a uniform grid sized so that each cell
+ * holds about two of them, and the buckets are stored back to back in one array, sorted
+ * by cell.  A nearest-node query searches rings of cells outward from the point and stops
+ * as soon as no unsearched cell can hold anything nearer than the best node found so far;
+ * a radius query only visits the cells that overlap the circle.  On maps where the nodes
+ * are spread out fairly evenly (as road networks are) both take constant expected time
+ * apart from the size of the result, where a plain scan looks at every node.
+ *
+ * The index holds the nodes' locations at the time it was built, and must be rebuilt if
+ * nodes are added to the graph or moved.
+ */
+
+#pragma once
+
+#include <cfloat>
+#include <vector>
+#include "graph.h"
+#include "point.h"
+#include "vector.h"
+#include "RoadGraph.h"
+
+class SpatialIndex {
+public:
+    /*
+     * Indexes every node of the graph.
+     */
+    explicit SpatialIndex(const Graph<RoadNode, RoadEdge>& graph);
+
+    /*
+     * Returns the number of nodes indexed.
+     */
+    int size() const;
+
+    /*
+     * Returns the node nearest to (x, y), or nullptr if there is no node within
+     * maxDistance of it (inclusive).  Of nodes at the same distance, any one may be
+     * returned.
+     */
+    RoadNode* nearest(double x, double y, double maxDistance = DBL_MAX) const;
+
+    /*
+     * Returns every node within the given distance of (x, y) (inclusive), nearest first.
+     */
+    Vector<RoadNode*> withinRadius(double x, double y, double radius) const;
+
+    /*
+     * Returns the node nearest to each of the points, as nearest() would, in the same
+     * order as the points.
+     */
+    Vector<RoadNode*> nearestToEach(const Vector<Point>& points, double maxDistance = DBL_MAX) const;
+
+private:
+    /* The nodes and their coordinates, sorted by cell; the nodes in cell c are at
+     * [cellStart[c], cellStart[c + 1]).  The coordinates are kept in their own arrays so
+     * that scanning a cell does not touch the nodes themselves.
+     */
+    std::vector<int> cellStart;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<RoadNode*> nodes;
+
+    double minX;                 // the corner of the grid with the smallest coordinates
+    double minY;
+    double cellSize;             // the width and height of each (square) cell
+    int columns;
+    int rows;
+
+    /*
+     * Returns the column / row of the cell that contains the given x / y coordinate,
+     * clamped to the grid.
+     */
+    int columnOf(double x) const;
+    int rowOf(double y) const;
+};
@@ -1,118 +1,199 @@
 /*
- * This sourcecode file implements three different graph search algorithms:
+ * This sourcecode file implements several different graph search algorithms:
  * [1] Breadth-First Search (BFS) using a standard queue data structure.
  * [2] Dijkstra's algorithm using a priority queue data structure.
  * [3] A* algorithm using a priority queue data structure and a heuristic metric
  *     composed of the minimum feasible time to traverse the straight-line distance
- *     between the current path endpoint and the desired final endpoint.
+ *     between the current path endpoint and the desired final endpoint, or the tighter
+ *     landmark (ALT) lower bound when landmark tables are supplied (see Landmarks.h).
+ * [4] Bidirectional variants of Dijkstra's algorithm and A*, which search from both ends
+ *     at once and stop when the two searches meet.
+ * [5] Alternative routes by the via-node method, which combine a forward and a backward
+ *     shortest-path tree into candidate routes through each node that both trees reach.
+ * The searches walk the CSR snapshot of the graph (see CompactRoadGraph.h) and keep per-node
+ * distance and predecessor tables (see SearchSpace.h) instead of queueing whole paths, and
+ * rebuild the resulting path once at the end.
 */
 
+#include <algorithm>
 #include <cfloat>
+#include <vector>
 
-#include "pqueue.h"
+#include "error.h"
 #include "queue.h"
 #include "hashset.h"
+#include "ArcFlags.h"
+#include "CompactRoadGraph.h"
+#include "IndexedHeap.h"
+#include "Landmarks.h"
+#include "SearchSpace.h"
 #include "Trailblazer.h"
 using namespace std;
 
 static const double SUFFICIENT_DIFFERENCE = 0.2;
 
+// Alternative routes costing more than this multiple of the best route are not considered
+static const double MAX_ALTERNATIVE_STRETCH = 2.0;
+
 // Function prototypes (instead of adding to Trailblazer.h)
-void visitNode(RoadNode* node, HashSet<string>& visitedNodes);
-void enqueueNeighbors(Queue<Path>& pathQ, const Path& currPath, RoadNode* node,
-                      const HashSet<string>& visitedNodes, const RoadGraph& graph);
-void enqueueNeighbors(PriorityQueue<Path>& pathQ, double& currCost, RoadNode* end, const bool useAstar, const Path& currPath,
-                      RoadNode* node, const HashSet<string>& visitedNodes, const RoadGraph& graph);
-double computeCost(const Path& currPath, const RoadGraph& graph);
-double computeHeuristic(RoadNode* start, RoadNode* end, const RoadGraph& graph);
-bool aStarHelper(const RoadGraph& graph, RoadNode* start, RoadNode* end, Path& solnPath);
-HashSet<RoadNode*> createNodeHashSet(Path& path);
-double computePathCost(Path& path, const RoadGraph& graph);
+void visitNode(SearchSpace& space, int nodeId, const SearchOptions& options);
+void enqueueNeighbors(Queue<int>& nodeQ, SearchSpace& space, int nodeId, const RoadGraph& graph,
+                      const SearchOptions& options);
+void enqueueNeighbors(IndexedHeap& openSet, SearchSpace& space, int nodeId, int endId,
+                      const bool useAstar, const RoadGraph& graph,
+                      const SearchOptions& options);
+double computeHeuristic(int nodeId, int endId, const RoadGraph& graph, const SearchOptions& options);
+double cachedPotential(SearchSpace& space, int nodeId, int startId, int endId, const bool bidirectional,
+                       const RoadGraph& graph, const SearchOptions& options);
+void checkPreprocessing(const RoadGraph& graph, const SearchOptions& options);
+void countQueueOperations(int numPushes, int numPops, int queueSize, const SearchOptions& options);
+bool weightedSearch(const RoadGraph& graph, RoadNode* start, RoadNode* end, const bool useAstar,
+                    const SearchOptions& options, Path& solnPath);
+bool aStarHelper(const RoadGraph& graph, RoadNode* start, RoadNode* end, Path& solnPath,
+                 const SearchOptions& options);
+double bidirectionalPotential(int nodeId, int startId, int endId, const RoadGraph& graph,
+                              const SearchOptions& options);
+void expandBidirectional(IndexedHeap& openSet, SearchSpace& space, const SearchSpace& otherSpace,
+                         const bool forward, int startId, int endId, const bool useAstar,
+                         const RoadGraph& graph, const SearchOptions& options, double& bestCost, int& meetId);
+Path bidirectionalSearch(const RoadGraph& graph, RoadNode* start, RoadNode* end, const bool useAstar,
+                         const SearchOptions& options);
+HashSet<RoadNode*> createNodeHashSet(const Path& path);
+bool isSufficientlyDifferent(const HashSet<RoadNode*>& chosenNodeSet, const HashSet<RoadNode*>& altNodeSet);
+void growViaTree(IndexedHeap& openSet, SearchSpace& space, const SearchSpace& otherSpace, const bool forward,
+                 int rootId, int targetId, const RoadGraph& graph, const SearchOptions& options,
+                 vector<int>& viaNodes);
 
 
 /*
  * Helper function for visiting a RoadNode in the trailblazing algorithms.
 */
-void visitNode(RoadNode* node, HashSet<string>& visitedNodes){
+void visitNode(SearchSpace& space, int nodeId, const SearchOptions& options){
 
-    visitedNodes.add(node->nodeName());
-    node->setColor(Color::GREEN);
+    space.markVisited(nodeId);
+    reportSettled(space.nodeAt(nodeId), options);
 
 }
 
 /*
  * Helper function for enqueueing neighbors of a node in preparation for path exploration.
  * Note that this function is overloaded to be used with a Queue data structure for BFS, or
- * a PriorityQueue data structure for Dijkstra and A*.
+ * an IndexedHeap for Dijkstra and A*.  Only node IDs are enqueued; the
+ * route taken to each node lives in the predecessor table of the search space.
 */
-void enqueueNeighbors(Queue<Path>& pathQ, const Path& currPath, RoadNode* node,
-                      const HashSet<string>& visitedNodes, const RoadGraph& graph){
-
-    Path newPath;
-    for (RoadNode* neighbor : graph.neighborsOf(node)){
-
-        if (!visitedNodes.contains(neighbor->nodeName())){
-            newPath = currPath;
-            newPath.add(neighbor);
-            pathQ.enqueue(newPath);
-            neighbor->setColor(Color::YELLOW);
-            newPath.clear();
+void enqueueNeighbors(Queue<int>& nodeQ, SearchSpace& space, int nodeId, const RoadGraph& graph,
+                      const SearchOptions& options){
+
+    const CompactRoadGraph& compact = graph.compact();
+    double currHops = space.distanceTo(nodeId);
+    reportRelaxed(compact.endEdge(nodeId) - compact.firstEdge(nodeId), options);
+
+    for (int edge = compact.firstEdge(nodeId); edge < compact.endEdge(nodeId); edge++){
+
+        int neighborId = compact.edgeTarget(edge);
+
+        // The first discovery of a node is the one with the fewest hops, so later ones are ignored
+        if (space.distanceTo(neighborId) == DBL_MAX){
+            space.relax(neighborId, nodeId, currHops + 1);
+            nodeQ.enqueue(neighborId);
+            reportFringe(compact.nodeAt(neighborId), options);
         }
     }
 }
 
-void enqueueNeighbors(PriorityQueue<Path>& pathQ, double& currCost, RoadNode* end, const bool useAstar,const Path& currPath,
-                      RoadNode* node, RoadEdge* neglectEdge, const HashSet<string>& visitedNodes, const RoadGraph& graph){
+void enqueueNeighbors(IndexedHeap& openSet, SearchSpace& space, int nodeId, int endId,
+                      const bool useAstar, const RoadGraph& graph,
+                      const SearchOptions& options){
 
-    Path newPath;
-    double updatedCost;
-    double heuristicCost;
-    // Computing the prior heuristic cost so that we can remove it from the new cost computations
-    double priorHeuristicCost = useAstar * computeHeuristic(node, end, graph);
+    const CompactRoadGraph& compact = graph.compact();
+    double currCost = space.distanceTo(nodeId);
+    reportRelaxed(compact.endEdge(nodeId) - compact.firstEdge(nodeId), options);
+    int endRegion = options.arcFlags != nullptr ? options.arcFlags->regionOf(endId) : 0;
 
-    for (RoadNode* neighbor : graph.neighborsOf(node)){
+    for (int edge = compact.firstEdge(nodeId); edge < compact.endEdge(nodeId); edge++){
 
-        if (neglectEdge != nullptr and node->nodeName() == neglectEdge->from()->nodeName() and
-            neighbor->nodeName() == neglectEdge->to()->nodeName()){
+        // Edges that lead toward no shortest path into the end's region need not be looked at
+        if (options.arcFlags != nullptr and !options.arcFlags->allows(edge, endRegion)){
             continue;
         }
 
-        if (!visitedNodes.contains(neighbor->nodeName())){
-
-            newPath = currPath;
-            newPath.add(neighbor);
+        int neighborId = compact.edgeTarget(edge);
+        if (space.isVisited(neighborId)){
+            continue;
+        }
 
-            // Taking current cost, removing the prior heuristic cost and then adding the new edge cost
-            updatedCost = currCost - priorHeuristicCost + computeCost(newPath, graph);
-            heuristicCost = useAstar * computeHeuristic(newPath[newPath.size() - 1], end, graph);
+        // Only updating the neighbor when this edge improves on its best known cost
+        double updatedCost = currCost + compact.edgeCost(edge);
+        if (updatedCost < space.distanceTo(neighborId)){
 
-            // Enqueuing with updated cost and the new hueristic cost
-            pathQ.enqueue(newPath, updatedCost + heuristicCost);
-            neighbor->setColor(Color::YELLOW);
+            space.relax(neighborId, nodeId, updatedCost);
 
-            newPath.clear();
+            // The heap is ordered by the cost so far plus the heuristic cost to the end.  A
+            // neighbor that is already queued has its priority lowered in place.
+            double heuristicCost = useAstar ? cachedPotential(space, neighborId, SearchSpace::NO_PARENT, endId, false, graph, options) : 0.0;
+            openSet.enqueueOrDecrease(neighborId, updatedCost + heuristicCost);
+            reportFringe(compact.nodeAt(neighborId), options);
         }
     }
 }
 
 /*
- * Helper function for computing the edge cost assoicated with the newest to entries to a path.
+ * Helper function for computing the heuristic cost from the last node in the current path
+ * to the desired end node.  With landmark tables this is the ALT bound, and otherwise the
+ * time needed to cover the straight-line distance at the top speed on the map.
 */
-double computeCost(const Path& currPath, const RoadGraph& graph){
+double computeHeuristic(int nodeId, int endId, const RoadGraph& graph, const SearchOptions& options){
 
-    size_t endIdx = currPath.size() - 1;
-    double cost = graph.edgeBetween(currPath[endIdx - 1], currPath[endIdx])->cost();
+    if (options.landmarks != nullptr){
+        return options.landmarks->lowerBound(nodeId, endId);
+    }
 
-    return cost;
+    // The snapshot's coordinate arrays spare a visit to both RoadNode objects
+    return graph.compact().crowFlyDistance(nodeId, endId) / graph.maxRoadSpeed();
 }
 
 /*
- * Helper function for computing the heuristic cost from the last node in the current path
- * to the desired end node.
+ * Helper function for looking up the potential of a node in an A* search, which is
+ * computed the first time the search reaches the node and read back from the search space
+ * whenever a cheaper route to it is found.  Bidirectional searches use the potential from
+ * bidirectionalPotential instead, and only they need startId.
+*/
+double cachedPotential(SearchSpace& space, int nodeId, int startId, int endId, const bool bidirectional,
+                       const RoadGraph& graph, const SearchOptions& options){
+
+    if (!space.hasPotential(nodeId)){
+        double potential = bidirectional ? bidirectionalPotential(nodeId, startId, endId, graph, options)
+                                         : computeHeuristic(nodeId, endId, graph, options);
+        space.setPotential(nodeId, potential);
+    }
+    return space.potentialOf(nodeId);
+}
+
+/*
+ * Helper function for rejecting landmark tables or arc flags that were built for a
+ * different graph, since their node and edge IDs would not match.
+*/
+void checkPreprocessing(const RoadGraph& graph, const SearchOptions& options){
+
+    if (options.landmarks != nullptr and &options.landmarks->compactGraph() != &graph.compact()){
+        error("The landmark tables were not built for this graph");
+    }
+    if (options.arcFlags != nullptr and &options.arcFlags->compactGraph() != &graph.compact()){
+        error("The arc flags were not built for this graph");
+    }
+}
+
+/*
+ * Helper function for counting the operations on the BFS queue, which (unlike the
+ * IndexedHeap) cannot count them itself.
 */
-double computeHeuristic(RoadNode* start, RoadNode* end, const RoadGraph& graph){
+void countQueueOperations(int numPushes, int numPops, int queueSize, const SearchOptions& options){
 
-    return graph.crowFlyDistanceBetween(start, end) / graph.maxRoadSpeed();
+    if (options.counters != nullptr){
+        options.counters->pushes += numPushes;
+        options.counters->pops += numPops;
+        options.counters->peakOpenSet = max(options.counters->peakOpenSet, (long long) queueSize);
+    }
 }
 
 /*
@@ -120,132 +201,287 @@ double computeHeuristic(RoadNode* start, RoadNode* end, const RoadGraph& graph){
 */
 Path breadthFirstSearch(const RoadGraph& graph, RoadNode* start, RoadNode* end) {
 
+    return breadthFirstSearch(graph, start, end, SearchOptions());
+}
 
-    Path pathVec;
-    pathVec.add(start);
+Path breadthFirstSearch(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options) {
 
-    Queue<Path> pathQ;
-    pathQ.enqueue(pathVec);
+    SearchTimer timer(options.counters);
 
-    HashSet<string> visitedNodes;
+    SearchSpace& space = SearchSpace::reusable(graph.compact());
+    int startId = space.idOf(start);
+    space.relax(startId, SearchSpace::NO_PARENT, 0.0);
 
-    while (!pathQ.isEmpty() and !visitedNodes.contains(end->nodeName())){
+    Queue<int> nodeQ;
+    nodeQ.enqueue(startId);
+    countQueueOperations(1, 0, nodeQ.size(), options);
 
-        Path currPath = pathQ.dequeue();
-        RoadNode* currLast = currPath[currPath.size() - 1];
+    while (!nodeQ.isEmpty()){
 
-        if (!visitedNodes.contains(currLast->nodeName())){
+        int currId = nodeQ.dequeue();
+        visitNode(space, currId, options);
 
-            visitNode(currLast, visitedNodes);
+        if (space.nodeAt(currId) == end) {
+            countQueueOperations(0, 1, nodeQ.size(), options);
+            return space.pathTo(currId);
+        }
 
-            if (currLast->nodeName() == end->nodeName()) {
-                return currPath;
-            }
+        int queueSize = nodeQ.size();
+        enqueueNeighbors(nodeQ, space, currId, graph, options);
+        countQueueOperations(nodeQ.size() - queueSize, 1, nodeQ.size(), options);
+    }
+
+    return {};
+}
+
+/*
+ * Shared implementation of Dijkstra's algorithm and A*, using an indexed heap of node IDs as
+ * the open set.  Each node is in the heap at most once, and cheaper routes found later lower
+ * its priority in place, so every dequeued node is settled exactly once.  With arc flags in
+ * the options, only edges flagged for the end node's region are followed.
+*/
+bool weightedSearch(const RoadGraph& graph, RoadNode* start, RoadNode* end, const bool useAstar,
+                    const SearchOptions& options, Path& solnPath){
+
+    SearchTimer timer(options.counters);
+    checkPreprocessing(graph, options);
+
+    const CompactRoadGraph& compact = graph.compact();
+    SearchSpace& space = SearchSpace::reusable(compact);
+    int startId = space.idOf(start);
+    int endId = space.idOf(end);
+    space.relax(startId, SearchSpace::NO_PARENT, 0.0);
+
+    IndexedHeap& openSet = IndexedHeap::reusable(compact.nodeCount(), options.heapArity);
+    openSet.countInto(options.counters);
+    openSet.enqueue(startId, useAstar ? computeHeuristic(startId, endId, graph, options) : 0.0);
 
-            enqueueNeighbors(pathQ, currPath, currLast, visitedNodes, graph);
+    while (!openSet.isEmpty()){
 
+        int currId = openSet.dequeue();
+        visitNode(space, currId, options);
+
+        if (currId == endId) {
+            solnPath = space.pathTo(currId);
+            return true;
         }
+
+        enqueueNeighbors(openSet, space, currId, endId, useAstar, graph, options);
     }
 
-    return {};
+    return false;
 }
 
 /*
- * Implementing Dijkstra's algorithm using a priority queue data structure.
+ * Implementing Dijkstra's algorithm using an indexed heap as the priority queue.
 */
 Path dijkstrasAlgorithm(const RoadGraph& graph, RoadNode* start, RoadNode* end) {
 
-    Path pathVec;
-    pathVec.add(start);
+    return dijkstrasAlgorithm(graph, start, end, SearchOptions());
+}
 
-    PriorityQueue<Path> pathQ;
-    pathQ.enqueue(pathVec, 0.0);
+Path dijkstrasAlgorithm(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options) {
 
-    HashSet<string> visitedNodes;
+    Path solnPath;
+    bool useAstar = false;
+    weightedSearch(graph, start, end, useAstar, options, solnPath);
 
-    while (!pathQ.isEmpty() and !visitedNodes.contains(end->nodeName())){
+    return solnPath;
+}
 
-        double currCost = pathQ.peekPriority();
-        Path currPath = pathQ.dequeue();
-        RoadNode* currLast = currPath[currPath.size() - 1];
+/*
+ * Implementing the A* algorithm using a priority queue data structure with a heuristic for
+ * underestimating the time-to-traverse cost computed using the straightline distance between
+ * two nodes divided by the maximum allowable speed on the graph, or the landmark bound from
+ * options.landmarks when it is set.
+*/
+bool aStarHelper(const RoadGraph& graph, RoadNode* start, RoadNode* end, Path& solnPath,
+                 const SearchOptions& options) {
 
-        if (!visitedNodes.contains(currLast->nodeName())){
+    bool useAstar = true;
+    return weightedSearch(graph, start, end, useAstar, options, solnPath);
+}
 
-            visitNode(currLast, visitedNodes);
+/*
+ * Nominal A* function, which calls the A* helper function
+*/
+Path aStar(const RoadGraph&graph, RoadNode* start, RoadNode* end) {
 
-            if (currLast->nodeName() == end->nodeName()) {
-                return currPath;
-            }
+    return aStar(graph, start, end, SearchOptions());
+}
 
-            bool useAstar = false;
-            enqueueNeighbors(pathQ, currCost, end, useAstar, currPath, currLast, {}, visitedNodes, graph);
-        }
+Path aStar(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options) {
+
+    Path solnPath;
+    bool solnFound = aStarHelper(graph, start, end, solnPath, options);
+
+    if (solnFound){
+        return solnPath;
     }
+    else{
+        return {};
+    }
+}
 
-    return {};
+/*
+ * Helper function for the potential used by bidirectional A*.  Averaging the forward
+ * heuristic (to the end) with the negated backward heuristic (from the start) gives both
+ * searches the same reduced edge costs, which is what lets them stop as soon as their
+ * frontiers provably meet.  The backward search uses the negation of this potential.
+*/
+double bidirectionalPotential(int nodeId, int startId, int endId, const RoadGraph& graph,
+                              const SearchOptions& options){
+
+    return (computeHeuristic(nodeId, endId, graph, options) - computeHeuristic(startId, nodeId, graph, options)) / 2;
 }
 
 /*
- * Implementing the A* algorithm using a priority queue data structure with a heuristic for
- * underestimating the time-to-traverse cost computed using the straightline distance between
- * two nodes divided by the maximum allowable speed on the graph.  Note that there is the
- * option for ignoring a specified edge in this implementation.
+ * Helper function for settling the front node of one side of a bidirectional search and
+ * relaxing its edges, in the forward direction (outgoing edges, potential sign +1) or the
+ * backward direction (incoming edges, potential sign -1).  Whenever a relaxed node has also
+ * been reached by the other side, the cost of the route through it is a candidate for the
+ * best meeting point.
 */
-bool aStarHelper(const RoadGraph& graph, RoadNode* start, RoadNode* end, Path& solnPath, RoadEdge* neglectEdge) {
+void expandBidirectional(IndexedHeap& openSet, SearchSpace& space, const SearchSpace& otherSpace,
+                         const bool forward, int startId, int endId, const bool useAstar,
+                         const RoadGraph& graph, const SearchOptions& options, double& bestCost, int& meetId){
 
-    Path pathVec;
-    pathVec.add(start);
+    const CompactRoadGraph& compact = graph.compact();
+    double potentialSign = forward ? 1.0 : -1.0;
 
-    PriorityQueue<Path> pathQ;
-    pathQ.enqueue(pathVec, computeHeuristic(start, end, graph));
+    int nodeId = openSet.dequeue();
+    visitNode(space, nodeId, options);
+    double currCost = space.distanceTo(nodeId);
 
-    HashSet<string> visitedNodes;
+    int firstEdge = forward ? compact.firstEdge(nodeId) : compact.firstInEdge(nodeId);
+    int endEdge = forward ? compact.endEdge(nodeId) : compact.endInEdge(nodeId);
+    reportRelaxed(endEdge - firstEdge, options);
 
-    while (!pathQ.isEmpty() and !visitedNodes.contains(end->nodeName())){
+    for (int edge = firstEdge; edge < endEdge; edge++){
 
-        double currCost = pathQ.peekPriority();
-        Path currPath = pathQ.dequeue();
-        size_t endIdx = currPath.size() - 1;
+        int neighborId = forward ? compact.edgeTarget(edge) : compact.inEdgeSource(edge);
+        if (space.isVisited(neighborId)){
+            continue;
+        }
 
-        RoadNode* currLast = currPath[endIdx];
+        double updatedCost = currCost + (forward ? compact.edgeCost(edge) : compact.inEdgeCost(edge));
+        if (updatedCost < space.distanceTo(neighborId)){
 
-        if (!visitedNodes.contains(currLast->nodeName())){
+            space.relax(neighborId, nodeId, updatedCost);
 
-            visitNode(currLast, visitedNodes);
+            double potential = useAstar ? potentialSign * cachedPotential(space, neighborId, startId, endId, true, graph, options) : 0.0;
+            openSet.enqueueOrDecrease(neighborId, updatedCost + potential);
+            reportFringe(compact.nodeAt(neighborId), options);
 
-            if (currLast->nodeName() == end->nodeName()) {
-                solnPath = currPath;
-                return true;
+            // Checking whether this node connects the two searches more cheaply than before
+            double otherCost = otherSpace.distanceTo(neighborId);
+            if (otherCost != DBL_MAX and updatedCost + otherCost < bestCost){
+                bestCost = updatedCost + otherCost;
+                meetId = neighborId;
             }
-
-            bool useAstar = true;
-            enqueueNeighbors(pathQ, currCost, end, useAstar, currPath, currLast, neglectEdge, visitedNodes, graph);
         }
     }
-
-    return false;
 }
 
 /*
- * Nominal A* function, which calls the A* helper function with no neglected edges
+ * Shared implementation of bidirectional Dijkstra and bidirectional A*.  A forward search
+ * from the start and a backward search from the end take turns, always advancing the side
+ * with the smaller open set.  The best route through any node reached by both sides is
+ * remembered, and the search stops once the two smallest queue priorities add up to at
+ * least its cost, since no undiscovered route can then be cheaper.
 */
-Path aStar(const RoadGraph&graph, RoadNode* start, RoadNode* end) {
+Path bidirectionalSearch(const RoadGraph& graph, RoadNode* start, RoadNode* end, const bool useAstar,
+                         const SearchOptions& options){
+
+    SearchTimer timer(options.counters);
+    checkPreprocessing(graph, options);
+
+    const CompactRoadGraph& compact = graph.compact();
+    SearchSpace& forwardSpace = SearchSpace::reusable(compact, 0);
+    SearchSpace& backwardSpace = SearchSpace::reusable(compact, 1);
+    IndexedHeap& forwardSet = IndexedHeap::reusable(compact.nodeCount(), options.heapArity, 0);
+    IndexedHeap& backwardSet = IndexedHeap::reusable(compact.nodeCount(), options.heapArity, 1);
+    forwardSet.countInto(options.counters);
+    backwardSet.countInto(options.counters);
+
+    int startId = forwardSpace.idOf(start);
+    int endId = backwardSpace.idOf(end);
+    if (startId == endId){
+        return {start};
+    }
 
-    Path solnPath;
-    bool solnFound = aStarHelper(graph, start, end, solnPath, {});
+    forwardSpace.relax(startId, SearchSpace::NO_PARENT, 0.0);
+    double startPotential = useAstar ? bidirectionalPotential(startId, startId, endId, graph, options) : 0.0;
+    double endPotential = useAstar ? bidirectionalPotential(endId, startId, endId, graph, options) : 0.0;
+    forwardSet.enqueue(startId, startPotential);
+    backwardSpace.relax(endId, SearchSpace::NO_PARENT, 0.0);
+    backwardSet.enqueue(endId, -endPotential);
 
-    if (solnFound){
-        return solnPath;
+    double bestCost = DBL_MAX;
+    int meetId = SearchSpace::NO_PARENT;
+
+    while (!forwardSet.isEmpty() and !backwardSet.isEmpty()){
+
+        if (forwardSet.peekPriority() + backwardSet.peekPriority() >= bestCost){
+            break;
+        }
+
+        if (forwardSet.size() <= backwardSet.size()){
+            expandBidirectional(forwardSet, forwardSpace, backwardSpace, true, startId, endId, useAstar,
+                                graph, options, bestCost, meetId);
+        }
+        else{
+            expandBidirectional(backwardSet, backwardSpace, forwardSpace, false, startId, endId, useAstar,
+                                graph, options, bestCost, meetId);
+        }
     }
-    else{
+
+    if (meetId == SearchSpace::NO_PARENT){
         return {};
     }
+
+    // The forward half runs from the start to the meeting node, and the backward search's
+    // predecessors lead the rest of the way from the meeting node to the end
+    Path solnPath = forwardSpace.pathTo(meetId);
+    for (int curr = backwardSpace.parentOf(meetId); curr != SearchSpace::NO_PARENT; curr = backwardSpace.parentOf(curr)){
+        solnPath.add(compact.nodeAt(curr));
+    }
+
+    return solnPath;
+}
+
+/*
+ * Bidirectional Dijkstra's algorithm.
+*/
+Path bidirectionalDijkstra(const RoadGraph& graph, RoadNode* start, RoadNode* end) {
+
+    return bidirectionalDijkstra(graph, start, end, SearchOptions());
+}
+
+Path bidirectionalDijkstra(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options) {
+
+    bool useAstar = false;
+    return bidirectionalSearch(graph, start, end, useAstar, options);
+}
+
+/*
+ * Bidirectional A*, using the averaged crow-fly (or landmark) potential.
+*/
+Path bidirectionalAStar(const RoadGraph& graph, RoadNode* start, RoadNode* end) {
+
+    return bidirectionalAStar(graph, start, end, SearchOptions());
+}
+
+Path bidirectionalAStar(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options) {
+
+    bool useAstar = true;
+    return bidirectionalSearch(graph, start, end, useAstar, options);
 }
 
 /*
  * Helper function for creating a Hashset of nodes contained in a path
 */
-HashSet<RoadNode*> createNodeHashSet(Path& path){
+HashSet<RoadNode*> createNodeHashSet(const Path& path){
 
     HashSet<RoadNode*> nodeSet;
     for (int ii = 0; ii < path.size() - 1; ii++){
@@ -255,55 +491,168 @@ HashSet<RoadNode*> createNodeHashSet(Path& path){
 }
 
 /*
- * Helper function for computing the cost of a path
+ * Helper function for deciding whether a candidate route is different enough from a route
+ * that was already chosen: more than SUFFICIENT_DIFFERENCE of the chosen route's nodes must
+ * be missing from the candidate.
+*/
+bool isSufficientlyDifferent(const HashSet<RoadNode*>& chosenNodeSet, const HashSet<RoadNode*>& altNodeSet){
+
+    double diffScore = (double)(chosenNodeSet - altNodeSet).size() / chosenNodeSet.size();
+    return diffScore > SUFFICIENT_DIFFERENCE;
+}
+
+/*
+ * Helper function for growing one of the two shortest-path trees used by the via-node
+ * search, rooted at the start (forward) or at the end (backward).  Nodes are settled until
+ * the open set holds nothing cheaper than MAX_ALTERNATIVE_STRETCH times the cost of the
+ * shortest route to the other end.  Settled nodes that the other tree also settled are
+ * added to viaNodes.
 */
-double computePathCost(Path& path, const RoadGraph& graph){
+void growViaTree(IndexedHeap& openSet, SearchSpace& space, const SearchSpace& otherSpace, const bool forward,
+                 int rootId, int targetId, const RoadGraph& graph, const SearchOptions& options,
+                 vector<int>& viaNodes){
+
+    double bestCost = DBL_MAX;
+    int meetId = SearchSpace::NO_PARENT;
+
+    space.relax(rootId, SearchSpace::NO_PARENT, 0.0);
+    openSet.enqueue(rootId, 0.0);
 
-    double cost = 0.0;
-    for (int ii = 0; ii < path.size() - 2; ii++){
-        cost += graph.edgeBetween(path[ii], path[ii + 1])->cost();
+    while (!openSet.isEmpty() and openSet.peekPriority() <= MAX_ALTERNATIVE_STRETCH * space.distanceTo(targetId)){
+
+        int nodeId = openSet.peek();
+        expandBidirectional(openSet, space, otherSpace, forward, rootId, targetId, false, graph, options,
+                            bestCost, meetId);
+        if (otherSpace.isVisited(nodeId)){
+            viaNodes.push_back(nodeId);
+        }
     }
-    return cost;
 }
 
 /*
- * Function for computing an alterantive route that differs from the best route by a
- * fixed threshold.  The alternative route is the minimum cost of all candidates.
+ * Function for computing alternative routes with the via-node method.  One shortest-path
+ * tree is grown forward from the start and one backward from the end, and every node v
+ * settled by both stands for the candidate route start -> v -> end that follows the two
+ * trees.  Candidates are tried from cheapest to most expensive; the cheapest is the best
+ * route itself, and any later one is kept when it differs sufficiently from the best route
+ * and from every alternative kept before it.  A node w on the candidate through v need not
+ * give the same route as a via node (its route follows the backward tree from w), but
+ * following the candidate shows viaCost(w) <= viaCost(v).  Nodes with viaCost(w) <
+ * viaCost(v) have therefore been tried already and are skipped afterwards; nodes that tie
+ * with v may still give a distinct route, so they are tried in turn.
 */
+Vector<Path> alternativeRoutes(const RoadGraph& graph, RoadNode* start, RoadNode* end, int k) {
 
-Path alternativeRoute(const RoadGraph& graph, RoadNode* start, RoadNode* end) {
+    return alternativeRoutes(graph, start, end, k, SearchOptions());
+}
 
-    Path bestPath = aStar(graph, start, end);
+Vector<Path> alternativeRoutes(const RoadGraph& graph, RoadNode* start, RoadNode* end, int k,
+                               const SearchOptions& options) {
 
-    HashSet<RoadNode*> bestNodeSet = createNodeHashSet(bestPath);
+    if (k < 0){
+        error("alternativeRoutes: the number of routes cannot be negative");
+    }
+    SearchTimer timer(options.counters);
+
+    const CompactRoadGraph& compact = graph.compact();
+    SearchSpace& forwardSpace = SearchSpace::reusable(compact, 0);
+    SearchSpace& backwardSpace = SearchSpace::reusable(compact, 1);
+    IndexedHeap& forwardSet = IndexedHeap::reusable(compact.nodeCount(), options.heapArity, 0);
+    IndexedHeap& backwardSet = IndexedHeap::reusable(compact.nodeCount(), options.heapArity, 1);
+    forwardSet.countInto(options.counters);
+    backwardSet.countInto(options.counters);
+
+    int startId = forwardSpace.idOf(start);
+    int endId = backwardSpace.idOf(end);
+
+    vector<int> viaNodes;
+    growViaTree(forwardSet, forwardSpace, backwardSpace, true, startId, endId, graph, options, viaNodes);
+    if (!forwardSpace.isVisited(endId)){
+        return {};
+    }
+    growViaTree(backwardSet, backwardSpace, forwardSpace, false, endId, startId, graph, options, viaNodes);
 
-    RoadEdge* currNeglectEdge;
+    auto viaCost = [&](int nodeId){
+        return forwardSpace.distanceTo(nodeId) + backwardSpace.distanceTo(nodeId);
+    };
+    sort(viaNodes.begin(), viaNodes.end(), [&](int a, int b){
+        return viaCost(a) < viaCost(b);
+    });
 
-    Path altSolnPath;
-    HashSet<RoadNode*> altNodeSet;
+    Vector<HashSet<RoadNode*>> chosenNodeSets;
+    Vector<Path> altPaths;
+    HashSet<int> triedNodes;
+    double maxCost = MAX_ALTERNATIVE_STRETCH * forwardSpace.distanceTo(endId);
 
-    double currAltSolnPathCost = DBL_MAX;
+    for (int viaId : viaNodes){
 
-    Path bestAltSolnPath = {};
+        if (altPaths.size() == k or viaCost(viaId) > maxCost){
+            break;
+        }
+        if (triedNodes.contains(viaId)){
+            continue;
+        }
 
-    for (int ii = 0; ii < bestPath.size() - 2; ii++){
-        currNeglectEdge = graph.edgeBetween(bestPath[ii], bestPath[ii + 1]);
-        bool foundAltSoln = aStarHelper(graph, start, end, altSolnPath, currNeglectEdge);
-        if (foundAltSoln){
-            altNodeSet = createNodeHashSet(altSolnPath);
-            double diffScore = (double)(bestNodeSet - altNodeSet).size() / bestNodeSet.size();
+        Path altSolnPath = forwardSpace.pathTo(viaId);
+        for (int curr = backwardSpace.parentOf(viaId); curr != SearchSpace::NO_PARENT; curr = backwardSpace.parentOf(curr)){
+            altSolnPath.add(compact.nodeAt(curr));
+        }
+        // Nodes on this route that are cheaper via nodes than viaId were tried before it
+        for (RoadNode* node : altSolnPath){
+            int nodeId = compact.indexOf(node);
+            if (viaCost(nodeId) < viaCost(viaId)){
+                triedNodes.add(nodeId);
+            }
+        }
 
-            if (diffScore > SUFFICIENT_DIFFERENCE){
-                double altPathSolnCost = computePathCost(altSolnPath, graph);
-                if (altPathSolnCost < currAltSolnPathCost){
-                    currAltSolnPathCost = altPathSolnCost;
-                    bestAltSolnPath = altSolnPath;
-                }
+        // The two halves can overlap and form a loop, which is never a sensible route.  The
+        // set leaves out the last node, so a forward half that already passed through the end
+        // (say into a cul-de-sac beside it) shows up as the end being in the set.
+        HashSet<RoadNode*> altNodeSet = createNodeHashSet(altSolnPath);
+        if (altNodeSet.size() != altSolnPath.size() - 1 or altNodeSet.contains(end)){
+            continue;
+        }
+
+        bool sufficientlyDifferent = true;
+        for (const HashSet<RoadNode*>& chosenNodeSet : chosenNodeSets){
+            if (!isSufficientlyDifferent(chosenNodeSet, altNodeSet)){
+                sufficientlyDifferent = false;
+                break;
             }
         }
-        altSolnPath.clear();
+        if (!sufficientlyDifferent){
+            continue;
+        }
+
+        // The first candidate accepted is the best route, which is not an alternative
+        if (!chosenNodeSets.isEmpty()){
+            altPaths.add(altSolnPath);
+        }
+        else if (altNodeSet.isEmpty()){
+            break;
+        }
+        chosenNodeSets.add(altNodeSet);
     }
 
-    return bestAltSolnPath;
+    return altPaths;
+}
+
+/*
+ * Function for computing an alterantive route that differs from the best route by a
+ * fixed threshold.  The alternative route is the cheapest of the routes found by
+ * alternativeRoutes().
+*/
+
+Path alternativeRoute(const RoadGraph& graph, RoadNode* start, RoadNode* end) {
+
+    return alternativeRoute(graph, start, end, SearchOptions());
 }
 
+Path alternativeRoute(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options) {
+
+    Vector<Path> altPaths = alternativeRoutes(graph, start, end, 1, options);
+    if (altPaths.isEmpty()){
+        return {};
+    }
+    return altPaths[0];
+}
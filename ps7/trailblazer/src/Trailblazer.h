@@ -20,6 +20,7 @@
 
 #include "vector.h"
 #include "RoadGraph.h"
+#include "SearchOptions.h"
 
 /**
  * Type: Path
@@ -38,6 +39,36 @@ Path dijkstrasAlgorithm(const RoadGraph& graph, RoadNode* start, RoadNode* end);
 Path aStar(const RoadGraph& graph, RoadNode* start, RoadNode* end);
 Path alternativeRoute(const RoadGraph& graph, RoadNode* start, RoadNode* end);
 
+/*
+ * Bidirectional variants of Dijkstra's algorithm and A*, which search forward from start and
+ * backward from end at the same time and stop once the two searches have provably met on a
+ * shortest path.
+ */
+
+Path bidirectionalDijkstra(const RoadGraph& graph, RoadNode* start, RoadNode* end);
+Path bidirectionalAStar(const RoadGraph& graph, RoadNode* start, RoadNode* end);
+
+/*
+ * Returns up to k alternatives to the shortest route from start to end, cheapest first.
+ * Each one differs sufficiently from the shortest route and from every cheaper alternative
+ * returned.  alternativeRoute() returns the first of them.
+ */
+
+Vector<Path> alternativeRoutes(const RoadGraph& graph, RoadNode* start, RoadNode* end, int k);
+
+/*
+ * Variants of the algorithms above that take extra settings (see SearchOptions.h).
+ */
+
+Path breadthFirstSearch(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options);
+Path dijkstrasAlgorithm(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options);
+Path aStar(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options);
+Path alternativeRoute(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options);
+Path bidirectionalDijkstra(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options);
+Path bidirectionalAStar(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options);
+Vector<Path> alternativeRoutes(const RoadGraph& graph, RoadNode* start, RoadNode* end, int k,
+                               const SearchOptions& options);
+
 #endif
 
 /*
@@ -53,6 +53,8 @@ namespace {
  */
 TrailblazerGUI::TrailblazerGUI(std::string windowTitle) {
     world = nullptr;
+    roadGraph = nullptr;
+    routingIndex = nullptr;
     animationDelay = 0;
     gtfPositionText = " ";
     
@@ -68,6 +70,10 @@ TrailblazerGUI::TrailblazerGUI(std::string windowTitle) {
     gcAlgorithm->addItem("BFS");
     gcAlgorithm->addItem("Dijkstra");
     gcAlgorithm->addItem("A*");
+    gcAlgorithm->addItem("A* with Landmarks");
+    gcAlgorithm->addItem("Bidirectional Dijkstra");
+    gcAlgorithm->addItem("Bidirectional A*");
+    gcAlgorithm->addItem("Contraction Hierarchies");
     gcAlgorithm->addItem("Alternative Route");
 
     gsDelay = new GSlider(ANIMATION_DELAY_MIN, ANIMATION_DELAY_MAX, ANIMATION_DELAY_DEFAULT);
@@ -131,6 +137,8 @@ TrailblazerGUI::~TrailblazerGUI() {
         delete gbRun;
         delete gWindow;
     }
+    delete routingIndex;
+    delete roadGraph;
     delete world;
 }
 
@@ -225,6 +233,10 @@ bool TrailblazerGUI::loadWorld(std::string worldFile) {
     }
 
     if (world) {
+        delete routingIndex;
+        routingIndex = nullptr;
+        delete roadGraph;
+        roadGraph = nullptr;
         delete world;
         world = nullptr;
         gWindow->repaint();
@@ -244,6 +256,12 @@ bool TrailblazerGUI::loadWorld(std::string worldFile) {
     bool readSuccessful = world->read(worldFile);
     if (readSuccessful) {
         std::cout << "Preparing world model ..." << std::endl;
+        roadGraph = new RoadGraph(world->getGraph());
+        routingIndex = new RoutingIndex(*roadGraph);
+        indexFile = worldFile + ".index";
+        if (routingIndex->load(indexFile)) {
+            std::cout << "Loaded preprocessed routing data from " << getTail(indexFile) << std::endl;
+        }
         snapConsoleLocation();
         
         gWindow->clearCanvas();
@@ -263,6 +281,13 @@ bool TrailblazerGUI::loadWorld(std::string worldFile) {
     return result;
 }
 
+void TrailblazerGUI::saveRoutingIndex() {
+    // A missing index only means the preprocessing is repeated next time, so failing is not an error
+    if (!routingIndex->save(indexFile)) {
+        std::cout << "Could not save preprocessed routing data to " << getTail(indexFile) << std::endl;
+    }
+}
+
 double TrailblazerGUI::costOf(const Vector<RoadNode*>& path) const {
     auto* graph = world->getGraph();
     double result = 0.0;
@@ -273,12 +298,13 @@ double TrailblazerGUI::costOf(const Vector<RoadNode*>& path) const {
     return result;
 }
 
-void TrailblazerGUI::displayPathInfo(Vector<RoadNode*>& path) {
+void TrailblazerGUI::displayPathInfo(Vector<RoadNode*>& path, const SearchCounters& counters) {
     std::cout << "Path length: " << path.size() << std::endl;
     std::cout << "Path cost: " << costOf(path) << std::endl;
 
     std::cout << "Locations explored (green nodes):   " << world->numGreenNodes() << std::endl;
     std::cout << "Locations in fringe (yellow nodes): " << world->numYellowNodes() << std::endl;
+    std::cout << "Search statistics: " << counters.toJson() << std::endl;
 
     std::cout << std::endl;
     std::cout << std::endl;
@@ -328,22 +354,50 @@ Vector<RoadNode*> TrailblazerGUI::runPathSearch() {
     std::cout << "Looking for a path from " << start->nodeName()
               << " to " << end->nodeName() << "." << std::endl;
 
-    RoadGraph graph(world->getGraph());
+    const RoadGraph& graph = *roadGraph;
     world->resetState();
 
+    SearchCounters counters;
+    SearchOptions options;
+    options.counters = &counters;
+
     if (algorithmLabel == "BFS") {
         std::cout << "Executing breadth-first search algorithm ..." << std::endl;
 
-        path = breadthFirstSearch(graph, start, end);
+        path = breadthFirstSearch(graph, start, end, options);
     } else if (algorithmLabel == "Dijkstra") {
         std::cout << "Executing Dijkstra's algorithm ..." << std::endl;
-        path = dijkstrasAlgorithm(graph, start, end);
+        path = dijkstrasAlgorithm(graph, start, end, options);
     } else if (algorithmLabel == "A*") {
         std::cout << "Executing A* algorithm ..." << std::endl;
-        path = aStar(graph, start, end);
+        path = aStar(graph, start, end, options);
+    } else if (algorithmLabel == "A* with Landmarks") {
+        if (!routingIndex->landmarks()) {
+            std::cout << "Preprocessing landmark distances ..." << std::endl;
+            routingIndex->setLandmarks(new Landmarks(graph));
+            saveRoutingIndex();
+        }
+        std::cout << "Executing A* algorithm with landmarks ..." << std::endl;
+        SearchOptions landmarkOptions = options;
+        landmarkOptions.landmarks = routingIndex->landmarks();
+        path = aStar(graph, start, end, landmarkOptions);
+    } else if (algorithmLabel == "Bidirectional Dijkstra") {
+        std::cout << "Executing bidirectional Dijkstra's algorithm ..." << std::endl;
+        path = bidirectionalDijkstra(graph, start, end, options);
+    } else if (algorithmLabel == "Bidirectional A*") {
+        std::cout << "Executing bidirectional A* algorithm ..." << std::endl;
+        path = bidirectionalAStar(graph, start, end, options);
+    } else if (algorithmLabel == "Contraction Hierarchies") {
+        if (!routingIndex->contractionHierarchy()) {
+            std::cout << "Preprocessing contraction hierarchy ..." << std::endl;
+            routingIndex->setContractionHierarchy(new ContractionHierarchy(graph));
+            saveRoutingIndex();
+        }
+        std::cout << "Executing contraction hierarchy query ..." << std::endl;
+        path = routingIndex->contractionHierarchy()->shortestPath(start, end, options);
     } else if (algorithmLabel == "Alternative Route") {
         std::cout << "Executing Alternative Route Search algorithm ..." << std::endl;
-        path = alternativeRoute(graph, start, end);
+        path = alternativeRoute(graph, start, end, options);
     }
     std::cout << "Algorithm complete." << std::endl;
     
@@ -375,7 +429,7 @@ Vector<RoadNode*> TrailblazerGUI::runPathSearch() {
     
     pathSearchInProgress = false;
     
-    displayPathInfo(path);
+    displayPathInfo(path, counters);
     if (animationDelay == 0) {
         // GUI will not have repainted itself to show the path being drawn;
         // manually repaint it
@@ -18,6 +18,7 @@
 #include "ginteractors.h"
 #include "gwindow.h"
 #include "observable.h"
+#include "RoutingIndex.h"
 #include "WorldDisplay.h"
 
 class TrailblazerGUI: public Observer<UIEvent> {
@@ -94,6 +95,9 @@ private:
     GButton* gbLoad;
     GButton* gbRun;
     WorldDisplay* world;   // current world being displayed on screen
+    RoadGraph* roadGraph;  // search view of the world's graph (caches its CSR snapshot)
+    RoutingIndex* routingIndex;  // preprocessing, loaded from indexFile or built on the first query that needs it
+    std::string indexFile;       // file the routing index is kept in, next to the world file
     int animationDelay;   // current animation delay in MS between redraws
     std::string gtfPositionText;   // text to display in gtfPosition (cached)
     bool pathSearchInProgress = false; // whether an operation is currently active
@@ -115,6 +119,12 @@ private:
      */
     bool loadWorld(std::string worldFile);
     
+    /*
+     * Saves the routing index next to the world file, so that the preprocessing built
+     * for this world does not have to be repeated the next time it is loaded.
+     */
+    void saveRoutingIndex();
+    
     /*
      * Given a path, returns the cost of that path.
      * Assumes path is valid and found in graph.
@@ -122,9 +132,10 @@ private:
     double costOf(const Vector<RoadNode*>& path) const;
     
     /*
-     * Displays information about the length, cost, etc. of a given path.
+     * Displays information about the length, cost, etc. of a given path, and the work the
+     * search did to find it.
      */
-    void displayPathInfo(Vector<RoadNode*>& path);
+    void displayPathInfo(Vector<RoadNode*>& path, const SearchCounters& counters);
     
     /*
      * Checks to make sure that a given path is valid on the current world graph.
@@ -0,0 +1,278 @@
+/*
+ * This sourcecode file implements the TravelTimeProfiles class and the earliest-arrival
+ * searches declared in TravelTimeProfiles.h.
+ */
+
+#include <algorithm>
+#include <cfloat>
+
+#include "error.h"
+#include "IndexedHeap.h"
+#include "SearchSpace.h"
+#include "TravelTimeProfiles.h"
+using namespace std;
+
+/* Private helper functions only needed in this file. */
+namespace {
+    /*
+     * Returns the dense edge ID of the edge, reporting an error if it is not in the graph.
+     */
+    int requireEdge(const CompactRoadGraph& compact, RoadEdge* edge) {
+        int index = compact.edgeIndexOf(edge);
+        if (index == CompactRoadGraph::NO_EDGE) {
+            error("TravelTimeProfiles: the edge is not part of this graph");
+        }
+        return index;
+    }
+
+    /*
+     * Time-dependent Dijkstra's algorithm / A*.  Node distances are arrival times, and an
+     * edge's cost is looked up at the time its start node is reached.  With FIFO edges an
+     * earlier arrival at a node never leads to a later arrival beyond it, so settling each
+     * node once at its earliest arrival is still correct.  Raising an edge's cost through
+     * RoadGraph::setEdgeCost() can break FIFO after its profile was assigned, so every
+     * relaxed edge is checked again.  The A* potential only depends on the node, so it is
+     * cached in the search space as in aStar().
+     */
+    Path earliestArrivalSearch(const RoadGraph& graph, const TravelTimeProfiles& profiles,
+                               RoadNode* start, RoadNode* end, double departureTime,
+                               bool useAstar, const SearchOptions& options) {
+
+        SearchTimer timer(options.counters);
+        const CompactRoadGraph& compact = graph.compact();
+        if (&profiles.compactGraph() != &compact) {
+            error("The travel-time profiles were not built for this graph");
+        }
+
+        SearchSpace& space = SearchSpace::reusable(compact);
+        int startId = space.idOf(start);
+        int endId = space.idOf(end);
+
+        // The crow-fly bound of aStar(), at the top speed any profile allows.  A map whose
+        // edges are all too short to have a speed gets no bound at all.
+        double topSpeed = graph.maxRoadSpeed();
+        double timePerDistance = topSpeed > 0 ? profiles.minFactor() / topSpeed : 0.0;
+        auto potentialOf = [&](int nodeId) {
+            if (!space.hasPotential(nodeId)) {
+                space.setPotential(nodeId, useAstar ? compact.crowFlyDistance(nodeId, endId) * timePerDistance : 0.0);
+            }
+            return space.potentialOf(nodeId);
+        };
+
+        IndexedHeap& openSet = IndexedHeap::reusable(compact.nodeCount(), options.heapArity);
+        openSet.countInto(options.counters);
+        space.relax(startId, SearchSpace::NO_PARENT, departureTime);
+        openSet.enqueue(startId, departureTime + potentialOf(startId));
+
+        while (!openSet.isEmpty()) {
+
+            int nodeId = openSet.dequeue();
+            space.markVisited(nodeId);
+            reportSettled(compact.nodeAt(nodeId), options);
+            if (nodeId == endId) {
+                return space.pathTo(nodeId);
+            }
+
+            double currTime = space.distanceTo(nodeId);
+            reportRelaxed(compact.endEdge(nodeId) - compact.firstEdge(nodeId), options);
+
+            for (int edge = compact.firstEdge(nodeId); edge < compact.endEdge(nodeId); edge++) {
+                int neighborId = compact.edgeTarget(edge);
+                if (space.isVisited(neighborId)) {
+                    continue;
+                }
+                if (!profiles.isFifo(edge)) {
+                    error("TravelTimeProfiles: an edge's cost was raised so far that its profile is no longer FIFO");
+                }
+                double arrival = currTime + profiles.travelTime(edge, currTime);
+                if (arrival < space.distanceTo(neighborId)) {
+                    space.relax(neighborId, nodeId, arrival);
+                    openSet.enqueueOrDecrease(neighborId, arrival + potentialOf(neighborId));
+                    reportFringe(compact.nodeAt(neighborId), options);
+                }
+            }
+        }
+
+        return {};
+    }
+}
+
+TravelTimeProfiles::TravelTimeProfiles(const RoadGraph& graph, double period)
+    : graph(graph.compact()),
+      periodLength(period),
+      smallestFactor(1.0),
+      edgeProfiles(graph.compact().edgeCount(), NO_PROFILE),
+      profileStarts(1, 0) {
+
+    if (!(period > 0)) {
+        error("TravelTimeProfiles: the period must be positive");
+    }
+}
+
+const CompactRoadGraph& TravelTimeProfiles::compactGraph() const {
+    return graph;
+}
+
+double TravelTimeProfiles::period() const {
+    return periodLength;
+}
+
+/*
+ * Identical profiles are found by their breakpoints, laid out as (time, factor) pairs, so
+ * that assigning the same profile to many edges does not store it many times.
+ */
+int TravelTimeProfiles::addProfile(const Vector<Breakpoint>& breakpoints) {
+
+    if (breakpoints.isEmpty()) {
+        error("TravelTimeProfiles::addProfile: a profile needs at least one breakpoint");
+    }
+    vector<double> key;
+    for (int ii = 0; ii < breakpoints.size(); ii++) {
+        const Breakpoint& point = breakpoints[ii];
+        if (!(point.time >= 0 and point.time < periodLength)
+                or (ii > 0 and !(point.time > breakpoints[ii - 1].time))) {
+            error("TravelTimeProfiles::addProfile: the breakpoint times must increase within the period");
+        }
+        if (!(point.factor >= 0)) {
+            error("TravelTimeProfiles::addProfile: the factors must not be negative");
+        }
+        key.push_back(point.time);
+        key.push_back(point.factor);
+    }
+
+    auto found = knownProfiles.find(key);
+    if (found != knownProfiles.end()) {
+        return found->second;
+    }
+
+    // The segment from the last breakpoint to the first one of the next period counts too
+    double lowestFactor = DBL_MAX;
+    double steepestSlope = 0.0;
+    int numPoints = breakpoints.size();
+    for (int ii = 0; ii < numPoints; ii++) {
+        const Breakpoint& point = breakpoints[ii];
+        const Breakpoint& next = breakpoints[(ii + 1) % numPoints];
+        double span = next.time - point.time + (ii + 1 == numPoints ? periodLength : 0.0);
+        lowestFactor = min(lowestFactor, point.factor);
+        steepestSlope = min(steepestSlope, (next.factor - point.factor) / span);
+        breakpointTimes.push_back(point.time);
+        breakpointFactors.push_back(point.factor);
+    }
+
+    int profile = profileMinFactors.size();
+    profileStarts.push_back(breakpointTimes.size());
+    profileMinFactors.push_back(lowestFactor);
+    profileMinSlopes.push_back(steepestSlope);
+    knownProfiles[key] = profile;
+    return profile;
+}
+
+int TravelTimeProfiles::profileCount() const {
+    return profileMinFactors.size();
+}
+
+/*
+ * An edge entered at time t is left at t + cost * f(t), which never decreases as long as
+ * cost * f'(t) >= -1, and f' is smallest on the steepest falling segment.
+ */
+void TravelTimeProfiles::setProfile(RoadEdge* edge, int profile) {
+
+    int index = requireEdge(graph, edge);
+    if (profile != NO_PROFILE) {
+        if (profile < 0 or profile >= profileCount()) {
+            error("TravelTimeProfiles::setProfile: there is no profile with that number");
+        }
+        if (graph.edgeCost(index) * profileMinSlopes[profile] < -1) {
+            error("TravelTimeProfiles::setProfile: the profile falls too steeply for this edge to stay FIFO");
+        }
+        smallestFactor = min(smallestFactor, profileMinFactors[profile]);
+    }
+    edgeProfiles[index] = profile;
+}
+
+int TravelTimeProfiles::profileOf(RoadEdge* edge) const {
+    return edgeProfiles[requireEdge(graph, edge)];
+}
+
+/*
+ * Consecutive nodes may be joined by more than one edge, and the trip takes whichever of
+ * them arrives first, as the searches do.
+ */
+double TravelTimeProfiles::arrivalTime(const Path& path, double departureTime) const {
+
+    double time = departureTime;
+    for (int ii = 1; ii < path.size(); ii++) {
+        int fromId = graph.indexOf(path[ii - 1]);
+        int toId = graph.indexOf(path[ii]);
+        if (fromId == CompactRoadGraph::NO_NODE or toId == CompactRoadGraph::NO_NODE) {
+            error("TravelTimeProfiles::arrivalTime: the path leaves the graph");
+        }
+
+        double bestArrival = DBL_MAX;
+        for (int edge = graph.firstEdge(fromId); edge < graph.endEdge(fromId); edge++) {
+            if (graph.edgeTarget(edge) == toId) {
+                bestArrival = min(bestArrival, time + travelTime(edge, time));
+            }
+        }
+        if (bestArrival == DBL_MAX) {
+            error("TravelTimeProfiles::arrivalTime: the path follows a missing edge");
+        }
+        time = bestArrival;
+    }
+    return time;
+}
+
+double TravelTimeProfiles::minFactor() const {
+    return smallestFactor;
+}
+
+/*
+ * Finds the breakpoints on either side of the time by binary search; before the first or
+ * after the last breakpoint, the segment wraps around to the neighboring period.
+ */
+double TravelTimeProfiles::factorAt(int profile, double timeOfDay) const {
+
+    int first = profileStarts[profile];
+    int last = profileStarts[profile + 1];
+    if (last - first == 1) {
+        return breakpointFactors[first];
+    }
+
+    int next = upper_bound(breakpointTimes.begin() + first, breakpointTimes.begin() + last, timeOfDay)
+               - breakpointTimes.begin();
+    double fromTime, toTime;
+    int from, to;
+    if (next == first) {
+        from = last - 1;
+        to = first;
+        fromTime = breakpointTimes[from] - periodLength;
+        toTime = breakpointTimes[to];
+    }
+    else if (next == last) {
+        from = last - 1;
+        to = first;
+        fromTime = breakpointTimes[from];
+        toTime = breakpointTimes[to] + periodLength;
+    }
+    else {
+        from = next - 1;
+        to = next;
+        fromTime = breakpointTimes[from];
+        toTime = breakpointTimes[to];
+    }
+
+    double fraction = (timeOfDay - fromTime) / (toTime - fromTime);
+    return breakpointFactors[from] + fraction * (breakpointFactors[to] - breakpointFactors[from]);
+}
+
+Path earliestArrivalDijkstra(const RoadGraph& graph, const TravelTimeProfiles& profiles,
+                             RoadNode* start, RoadNode* end, double departureTime,
+                             const SearchOptions& options) {
+    return earliestArrivalSearch(graph, profiles, start, end, departureTime, false, options);
+}
+
+Path earliestArrivalAStar(const RoadGraph& graph, const TravelTimeProfiles& profiles,
+                          RoadNode* start, RoadNode* end, double departureTime,
+                          const SearchOptions& options) {
+    return earliestArrivalSearch(graph, profiles, start, end, departureTime, true, options);
+}
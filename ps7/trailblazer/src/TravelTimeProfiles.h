@@ -0,0 +1,180 @@
+/*
+ * This header declares the TravelTimeProfiles class, which lets the time needed to cross
+ * an edge depend on the time of day, and the earliest-arrival searches that route over it.
+ *
+ * A profile is a piecewise-linear function of the time of day that repeats every period
+ * (e.g. every 24 hours), given by its breakpoints.  Its value is a factor: an edge with
+ * the profile takes its ordinary cost (RoadEdge::cost()) times the factor at the moment it
+ * is entered.  Because profiles scale the cost rather than replace it, all the edges of
+ * one kind of road can share a single profile, so a map needs only a handful of them: the
+ * distinct profiles are stored once each, in flat arrays, and every edge stores just the
+ * number of its profile.  Edges without one always take their ordinary cost.
+ *
+ * Every profile must satisfy the FIFO (first in, first out) property on every edge it is
+ * given to: entering an edge later never gets you out of it earlier.  For a piecewise-
+ * linear travel time that means no segment may fall faster than time passes, which is
+ * checked when a profile is assigned to an edge and again for every edge the searches
+ * below relax, since raising an edge's cost later can break it.  With FIFO edges, waiting
+ * never pays, so those label-setting searches find the earliest possible arrival.
+ *
+ * The profiles use the dense edge IDs of the graph's CSR snapshot, and read the edges'
+ * current costs from it, so cost changes made through RoadGraph::setEdgeCost() apply to
+ * them too; a search that meets an edge no longer FIFO at its new cost reports an error.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <map>
+#include <vector>
+#include "vector.h"
+#include "CompactRoadGraph.h"
+#include "RoadGraph.h"
+#include "SearchOptions.h"
+#include "Trailblazer.h"
+
+class TravelTimeProfiles {
+public:
+    /* Profile number of edges that always take their ordinary cost. */
+    static const int NO_PROFILE = -1;
+
+    /*
+     * One breakpoint of a profile: at the given time of day (from 0 up to the period), an
+     * edge takes the given factor times its cost.
+     */
+    struct Breakpoint {
+        double time;
+        double factor;
+    };
+
+    /*
+     * Constructs profiles over the given graph that repeat every period time units (in
+     * the units of the edge costs), with every edge taking its ordinary cost at all times.
+     */
+    TravelTimeProfiles(const RoadGraph& graph, double period);
+
+    /*
+     * Returns the CSR snapshot whose dense edge IDs the profiles use.
+     */
+    const CompactRoadGraph& compactGraph() const;
+
+    /*
+     * Returns the length of the period after which every profile repeats.
+     */
+    double period() const;
+
+    /*
+     * Adds the profile with the given breakpoints and returns its number, or the number of
+     * an identical profile added before.  The breakpoints must be sorted by strictly
+     * increasing time within [0, period) and have non-negative factors; between the last
+     * breakpoint and the first one of the next period, the factor changes linearly too.
+     */
+    int addProfile(const Vector<Breakpoint>& breakpoints);
+
+    /*
+     * Returns the number of distinct profiles added.
+     */
+    int profileCount() const;
+
+    /*
+     * Gives the edge the profile with the given number (or NO_PROFILE, so that it always
+     * takes its ordinary cost).  Reports an error if the edge's travel time would not be
+     * FIFO with the profile.
+     */
+    void setProfile(RoadEdge* edge, int profile);
+
+    /*
+     * Returns the number of the edge's profile, or NO_PROFILE.
+     */
+    int profileOf(RoadEdge* edge) const;
+
+    /*
+     * Returns the time needed to cross the edge with the given dense ID when entering it
+     * at the given time (any time, not just one within the first period).
+     */
+    double travelTime(int edge, double departureTime) const;
+
+    /*
+     * Returns whether the travel time of the edge with the given dense ID is FIFO at the
+     * edge's current cost.
+     */
+    bool isFifo(int edge) const;
+
+    /*
+     * Returns the time at which a trip along the path that departs at the given time
+     * reaches its end, or the departure time itself for paths with fewer than two nodes.
+     */
+    double arrivalTime(const Path& path, double departureTime) const;
+
+    /*
+     * Returns a factor that no edge's travel time ever falls below, relative to its cost.
+     * Dividing the graph's top road speed by it gives the top speed at any time of day.
+     */
+    double minFactor() const;
+
+private:
+    const CompactRoadGraph& graph;
+    double periodLength;
+    double smallestFactor;                 // minFactor(), over the profiles given to edges
+
+    std::vector<int> edgeProfiles;         // dense edge ID -> profile number, or NO_PROFILE
+
+    /* The breakpoints of every profile, one after another: those of profile p occupy
+     * [profileStarts[p], profileStarts[p + 1]).
+     */
+    std::vector<int> profileStarts;
+    std::vector<double> breakpointTimes;
+    std::vector<double> breakpointFactors;
+    std::vector<double> profileMinFactors;  // profile -> smallest factor
+    std::vector<double> profileMinSlopes;   // profile -> steepest fall of the factor per time unit
+    std::map<std::vector<double>, int> knownProfiles;   // breakpoints as (time, factor) pairs -> profile
+
+    /*
+     * Returns the factor of the given profile at the given time, which must lie within
+     * [0, period).
+     */
+    double factorAt(int profile, double timeOfDay) const;
+};
+
+/*
+ * travelTime() is called once per relaxed edge, so it is defined here where the compiler
+ * can inline the common case of an edge without a profile.
+ */
+inline double TravelTimeProfiles::travelTime(int edge, double departureTime) const {
+    int profile = edgeProfiles[edge];
+    if (profile == NO_PROFILE) {
+        return graph.edgeCost(edge);
+    }
+    double timeOfDay = std::fmod(departureTime, periodLength);
+    if (timeOfDay < 0) {
+        timeOfDay += periodLength;
+    }
+    return graph.edgeCost(edge) * factorAt(profile, timeOfDay);
+}
+
+/*
+ * The same test setProfile() makes, at the edge's cost as it is now.
+ */
+inline bool TravelTimeProfiles::isFifo(int edge) const {
+    int profile = edgeProfiles[edge];
+    return profile == NO_PROFILE or graph.edgeCost(edge) * profileMinSlopes[profile] >= -1;
+}
+
+/*
+ * Returns the path from start to end that arrives earliest when leaving start at the
+ * given departure time, using Dijkstra's algorithm over the profiles' travel times.  The
+ * path is empty if end cannot be reached.  Use TravelTimeProfiles::arrivalTime() to find
+ * when the path arrives.  The landmarks and arcFlags settings were built from the
+ * ordinary costs, so they are ignored.
+ */
+Path earliestArrivalDijkstra(const RoadGraph& graph, const TravelTimeProfiles& profiles,
+                             RoadNode* start, RoadNode* end, double departureTime,
+                             const SearchOptions& options = SearchOptions());
+
+/*
+ * Variant of earliestArrivalDijkstra() that runs A*, with the crow-fly heuristic of
+ * aStar() adjusted to the top speed at any time of day (see TravelTimeProfiles::minFactor()).
+ */
+Path earliestArrivalAStar(const RoadGraph& graph, const TravelTimeProfiles& profiles,
+                          RoadNode* start, RoadNode* end, double departureTime,
+                          const SearchOptions& options = SearchOptions());
@@ -11,6 +11,8 @@
  */
 
 #include "WorldDisplay.h"
+#include "SpatialIndex.h"
+#include "WorldFile.h"
 #include <cmath>
 #include <fstream>
 #include <sstream>
@@ -47,19 +49,6 @@ namespace {
         newX = x + dx;
         newY = y - dy;
     }
-
-    /* Reads files from the stream until a non-empty, non-comment line is read. */
-    bool getMeaningfulLine(std::istream& input, std::string& line) {
-        std::string lineOut;
-        while (getline(input, lineOut)) {
-            trimInPlace(lineOut);
-            if (!lineOut.empty() && lineOut[0] != '#') {
-                line = lineOut;
-                return true;
-            }
-        }
-        return false;
-    }
 }
 
 const int WorldDisplay::WINDOW_MARGIN = 5;
@@ -70,6 +59,7 @@ WorldDisplay::WorldDisplay(GWindow* gwnd)
       windowWidth(0),
       windowHeight(0),
       graph(nullptr),
+      nodeIndex(nullptr),
       selectedStart(nullptr),
       selectedEnd(nullptr),
       backgroundImage(nullptr) {
@@ -83,6 +73,7 @@ WorldDisplay::~WorldDisplay() {
     clearPath(false);
     
     delete backgroundImage;
+    delete nodeIndex;
     delete graph;
 }
 
@@ -123,12 +114,12 @@ RoadNode* WorldDisplay::getSelectedEnd() const {
 }
 
 bool WorldDisplay::read(const std::string& filename) {
-    std::ifstream input;
-    input.open(filename.c_str());
-    if (input.fail()) {
+    resetGraph();
+    WorldFileHeader header;
+    if (!readWorldFileCached(filename, filename + ".cache", header, *graph)) {
         return false;
     }
-    return read(input);
+    return finishRead(header);
 }
 
 void WorldDisplay::setSelectedStart(RoadNode* v) {
@@ -291,16 +282,11 @@ std::string WorldDisplay::getType() const {
 }
 
 RoadNode* WorldDisplay::getVertex(double x, double y) const {
-    for (auto* v : *graph) {
-        Point p = v->location();
-        GOval oval(p.getX() - VERTEX_RADIUS,
-                   p.getY() - VERTEX_RADIUS,
-                   2 * VERTEX_RADIUS, 2 * VERTEX_RADIUS);
-        if (oval.contains(x, y)) {
-            return v;
-        }
+    // the clicked vertex is the nearest one whose circle contains the click
+    if (!nodeIndex) {
+        return nullptr;
     }
-    return nullptr;
+    return nodeIndex->nearest(x, y, VERTEX_RADIUS);
 }
 
 void WorldDisplay::handleClick(double x, double y) {
@@ -335,165 +321,42 @@ void WorldDisplay::handleClick(double x, double y) {
 }
 
 bool WorldDisplay::read(std::istream& input) {
+    resetGraph();
+    WorldFileHeader header;
+    if (!readWorldFile(input, header, *graph)) {
+        return false;
+    }
+    return finishRead(header);
+}
+
+void WorldDisplay::resetGraph() {
     if (graph) {
         delete graph;
     }
+    delete nodeIndex;
+    nodeIndex = nullptr;
     graph = new Graph<RoadNode, RoadEdge>();
     largeMapDisplay = false;
-    
-    std::string line;
-    if (!getMeaningfulLine(input, line)) {   // "FLAGS or IMAGE"
-        std::cerr << "Invalid input file; file is empty" << std::endl;
-        return false;
-    }
-    if(line == "FLAGS") {
-        std::string flagLine;
-        while (true) {
-            if(!getMeaningfulLine(input, flagLine)) {
-                std::cerr << "Invalid input file; missing \"IMAGE\" header" << std::endl;
-                return false;
-            }
-            if(flagLine == "IMAGE") break;
-            Vector<std::string> parts = stringSplit(flagLine, "=");
-            if(parts[0] == "largeMapDisplay") {
-                largeMapDisplay = parts[1] == "true";
-            }
-        }
-    }
+}
 
+bool WorldDisplay::finishRead(const WorldFileHeader& header) {
+    largeMapDisplay = header.largeMapDisplay;
 
-    std::string imageFile;
-    if (!getMeaningfulLine(input, imageFile)) {
-        std::cerr << "Invalid input file; missing image file name" << std::endl;
-        return false;
-    }
-    if (!fileExists(imageFile)) {
+    if (!fileExists(header.imageFile)) {
         std::cerr << "Invalid input file; specified image file \""
-                  << imageFile << "\" does not exist" << std::endl;
-        return false;
-    }
-    backgroundImage = new GImage(imageFile);
-    
-    int width = 0;
-    if (!getMeaningfulLine(input, line)) {
-        std::cerr << "Invalid input file; missing width" << std::endl;
-        return false;
-    }
-    if (!stringIsInteger(line)) {
-        std::cerr << "Invalid input file; non-integer width \""
-                  << line << "\"" << std::endl;
-        return false;
-    }
-    width = stringToInteger(line);
-    
-    int height = 0;
-    if (!getMeaningfulLine(input, line)) {
-        std::cerr << "Invalid input file; missing height" << std::endl;
-        return false;
-    }
-    if (!stringIsInteger(line)) {
-        std::cerr << "Invalid input file; non-integer height \""
-                  << line << "\"" << std::endl;
+                  << header.imageFile << "\" does not exist" << std::endl;
         return false;
     }
-    height = stringToInteger(line);
-    preferredSize = GDimension(width, height);
-    windowWidth = width;
-    windowHeight = height;
-    
-    getline(input, line);  // VERTICES
-    while (getMeaningfulLine(input, line)) {
-        // "Hobbiton;147;86"
-        std::vector<std::string> tokens = stringSplit(line, ";");
-        if (tokens.size() >= 1 && (tokens[0] == "ARCS" || tokens[0] == "EDGES")) {
-            break;
-        } else if (tokens.size() < 3) {
-            continue;
-        }
-        
-        std::string name = trim(tokens[0]);
-        if (graph->containsNode(name)) {
-            std::cerr << "Invalid input file; duplicate vertex \""
-                      << name << "\"" << std::endl;
-            return false;
-        }
-        
-        if (!stringIsInteger(tokens[1]) || !stringIsInteger(tokens[2])) {
-            std::cerr << "Invalid input file; non-integer coordinates for vertex \""
-                      << name << "\"" << std::endl;
-            return false;
-        }
-        int vertexX = stringToInteger(tokens[1]);
-        int vertexY = stringToInteger(tokens[2]);
-        if (vertexX < 0 || vertexY < 0) {
-            std::cerr << "Invalid input file; negative coordinates for vertex \""
-                      << name << "\"" << std::endl;
-            return false;
-        }
-
-        RoadNode* node = new RoadNode(name, {vertexX, vertexY});
-        node->addObserver(this);
-        graph->addNode(node);
-    }
-    
-    while (getMeaningfulLine(input, line)) {
-        // "Hobbiton;Southfarthing;1"
-        std::vector<std::string> tokens = stringSplit(line, ";");
-        if (tokens.size() < 3) {
-            break;
-        }
-        std::string name1 = trim(tokens[0]);
-        std::string name2 = trim(tokens[1]);
-        
-        if (!graph->containsNode(name1)) {
-            std::cerr << "Invalid input file; when reading edge between \""
-                      << name1 << "\" and \"" << name2
-                      << "\", graph does not contain a vertex named \""
-                      << name1 << "\"" << std::endl;
-            return false;
-        }
-        if (!graph->containsNode(name2)) {
-            std::cerr << "Invalid input file; when reading edge between \""
-                      << name1 << "\" and \"" << name2
-                      << "\", graph does not contain a vertex named \""
-                      << name2 << "\"" << std::endl;
-            return false;
-        }
-        
-        if (!stringIsReal(tokens[2])) {
-            std::cerr << "Invalid input file; non-numeric weight for edge between \""
-                      << name1 << "\" and \"" << name2 << "\"" << std::endl;
-            return false;
-        }
-        
-        double weight = stringToReal(tokens[2]);
-        if (weight < 0) {
-            std::cerr << "Invalid input file; negative weight for edge between \""
-                      << name1 << "\" and \"" << name2 << "\"" << std::endl;
-            return false;
-        }
-
+    backgroundImage = new GImage(header.imageFile);
 
+    preferredSize = GDimension(header.width, header.height);
+    windowWidth = header.width;
+    windowHeight = header.height;
 
-        // edges are undirected (both ways) by default
-        bool directed = false;
-        if (tokens.size() >= 4 && stringIsBool(tokens[3])) {
-            directed = stringToBool(tokens[3]);
-        }
-
-        /* Add the forward edge. */
-        RoadEdge* edge = new RoadEdge(graph->getNode(name1), graph->getNode(name2), weight);
-        graph->addArc(edge);
-
-        /* The graph might be undirected, in which case we should add the reverse edge as
-         * well.
-         */
-        if (!directed) {
-            RoadEdge* revEdge = new RoadEdge(graph->getNode(name2), graph->getNode(name1), weight);
-            graph->addArc(revEdge);
-        }
+    for (RoadNode* node : *graph) {
+        node->addObserver(this);
     }
-
+    nodeIndex = new SpatialIndex(*graph);
 
     return true;
 }
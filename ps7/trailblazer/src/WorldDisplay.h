@@ -20,6 +20,8 @@
 #include "Color.h"
 #include "RoadGraph.h"
 #include "hashset.h"
+#include "SpatialIndex.h"
+#include "WorldFile.h"
 #include <string>
 #include <fstream>
 
@@ -90,8 +92,11 @@ public:
     void setSelectedStart(RoadNode* v);
 
     /*
-     * Reads graph data from the given filename.
-     * This method simply forwards to read(istream&).
+     * Reads graph data from the given filename, through the binary cache kept next to it
+     * in <filename>.cache (see readWorldFileCached in WorldFile.h).  Note that this writes
+     * that cache file beside the map the first time the map is loaded, and rewrites it
+     * whenever the map has changed since; if the directory is read-only the map is simply
+     * parsed each time.
      */
     bool read(const std::string& filename);
     
@@ -149,6 +154,7 @@ private:
     double windowHeight;
     GDimension preferredSize;         // size graph would like to be
     Graph<RoadNode, RoadEdge>* graph; // the graph itself
+    SpatialIndex* nodeIndex;          // finds the vertex under a click (nullptr if no graph)
     RoadNode* selectedStart;          // currently selected start/end vertices
     RoadNode* selectedEnd;            // from clicks (nullptr if none)
     Vector<GLine*> highlightedPath;   // highlighted path lines (empty if none)
@@ -181,6 +187,17 @@ private:
      */
     void drawVertexCircle(RoadNode* v, std::string color, bool fill = true);
     
+    /*
+     * Discards the current graph and its node index, leaving an empty graph to read into.
+     */
+    void resetGraph();
+
+    /*
+     * Sets up the display for the graph just read with the given header: background
+     * image, size, node observers and node index.  Returns false if the image is missing.
+     */
+    bool finishRead(const WorldFileHeader& header);
+
     /*
      * Maps from x/y positions on screen to vertices in the graph.
      */
@@ -0,0 +1,640 @@
+/*
+ * CS 106B Trailblazer
+ * This file implements the world file readers and writers declared in WorldFile.h. The
+ * parsing code was moved here from WorldDisplay::read so that it can run without a window.
+ *
+ * The text is parsed in a single pass over one in-memory copy of the file, into the flat
+ * arrays of a WorldData, and the Graph is only built from those arrays at the end.  The
+ * same arrays are what the binary format stores.
+ *
+ * @author Chris Piech, Marty Stepp, Keith Schwarz, et al
+ * @version 2017/03/09 (updated version for Win17)
+ */
+
+#include "WorldFile.h"
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+#include "MappedFile.h"
+
+/* Private types and helper functions needed only in this file. */
+namespace {
+    /*
+     * A range of characters inside the text being parsed.
+     */
+    struct Span {
+        const char* begin;
+        const char* end;
+
+        bool isEmpty() const { return begin == end; }
+        bool equals(const char* text) const {
+            size_t length = strlen(text);
+            return size_t(end - begin) == length && memcmp(begin, text, length) == 0;
+        }
+        std::string str() const { return std::string(begin, end); }
+    };
+
+    /* Returns the span without its leading and trailing whitespace. */
+    Span trimSpan(Span span) {
+        while (span.begin < span.end && isspace((unsigned char) *span.begin)) {
+            span.begin++;
+        }
+        while (span.end > span.begin && isspace((unsigned char) span.end[-1])) {
+            span.end--;
+        }
+        return span;
+    }
+
+    /* Splits the span at every occurrence of the delimiter, like stringSplit. */
+    void splitSpan(Span span, char delimiter, std::vector<Span>& tokens) {
+        tokens.clear();
+        const char* tokenStart = span.begin;
+        for (const char* curr = span.begin; curr < span.end; curr++) {
+            if (*curr == delimiter) {
+                tokens.push_back({tokenStart, curr});
+                tokenStart = curr + 1;
+            }
+        }
+        if (tokenStart < span.end) {
+            tokens.push_back({tokenStart, span.end});
+        }
+    }
+
+    /* Parses a whole (trimmed) span as an int, like stringIsInteger / stringToInteger. */
+    bool parseInteger(Span span, int& value) {
+        span = trimSpan(span);
+        const char* curr = span.begin;
+        bool negative = false;
+        if (curr < span.end && (*curr == '-' || *curr == '+')) {
+            negative = *curr == '-';
+            curr++;
+        }
+        if (curr == span.end) {
+            return false;
+        }
+        long long result = 0;
+        for (; curr < span.end; curr++) {
+            if (!isdigit((unsigned char) *curr)) {
+                return false;
+            }
+            result = result * 10 + (*curr - '0');
+            if (result > 2147483648LL) {
+                return false;
+            }
+        }
+        result = negative ? -result : result;
+        if (result > 2147483647LL) {
+            return false;
+        }
+        value = (int) result;
+        return true;
+    }
+
+    /* Parses a whole (trimmed) span as a finite double, like stringIsReal / stringToReal. */
+    bool parseReal(Span span, double& value) {
+        span = trimSpan(span);
+        // strtod needs a terminated string, and the span is not one
+        char text[64];
+        size_t length = span.end - span.begin;
+        if (length == 0 || length >= sizeof(text)) {
+            return false;
+        }
+        memcpy(text, span.begin, length);
+        text[length] = '\0';
+
+        char* parsedEnd;
+        value = strtod(text, &parsedEnd);
+        return parsedEnd == text + length && std::isfinite(value);
+    }
+
+    /*
+     * Hands out the lines of a block of text one at a time.
+     */
+    class LineReader {
+    public:
+        LineReader(const char* begin, const char* end) : curr(begin), end(end) {}
+
+        /* Reads the next line, like getline. */
+        bool nextLine(Span& line) {
+            if (curr >= end) {
+                return false;
+            }
+            const char* lineEnd = static_cast<const char*>(memchr(curr, '\n', end - curr));
+            if (lineEnd == nullptr) {
+                lineEnd = end;
+            }
+            line = {curr, lineEnd};
+            curr = lineEnd < end ? lineEnd + 1 : end;
+            return true;
+        }
+
+        /* Reads lines until a non-empty, non-comment line is read, and trims it. */
+        bool nextMeaningfulLine(Span& line) {
+            while (nextLine(line)) {
+                line = trimSpan(line);
+                if (!line.isEmpty() && *line.begin != '#') {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        const char* curr;
+        const char* end;
+    };
+
+    /*
+     * Parses the text of a world file. On failure, prints a message to cerr and returns false.
+     */
+    bool parseWorldText(const char* begin, const char* end, WorldData& world) {
+        LineReader reader(begin, end);
+        WorldFileHeader& header = world.header;
+        header.largeMapDisplay = false;
+
+        Span line;
+        std::vector<Span> tokens;
+        if (!reader.nextMeaningfulLine(line)) {   // "FLAGS or IMAGE"
+            std::cerr << "Invalid input file; file is empty" << std::endl;
+            return false;
+        }
+        if (line.equals("FLAGS")) {
+            while (true) {
+                if (!reader.nextMeaningfulLine(line)) {
+                    std::cerr << "Invalid input file; missing \"IMAGE\" header" << std::endl;
+                    return false;
+                }
+                if (line.equals("IMAGE")) break;
+                splitSpan(line, '=', tokens);
+                if (tokens.size() >= 1 && tokens[0].equals("largeMapDisplay")) {
+                    header.largeMapDisplay = tokens.size() >= 2 && tokens[1].equals("true");
+                }
+            }
+        }
+
+        if (!reader.nextMeaningfulLine(line)) {
+            std::cerr << "Invalid input file; missing image file name" << std::endl;
+            return false;
+        }
+        header.imageFile = line.str();
+
+        if (!reader.nextMeaningfulLine(line)) {
+            std::cerr << "Invalid input file; missing width" << std::endl;
+            return false;
+        }
+        if (!parseInteger(line, header.width)) {
+            std::cerr << "Invalid input file; non-integer width \""
+                      << line.str() << "\"" << std::endl;
+            return false;
+        }
+
+        if (!reader.nextMeaningfulLine(line)) {
+            std::cerr << "Invalid input file; missing height" << std::endl;
+            return false;
+        }
+        if (!parseInteger(line, header.height)) {
+            std::cerr << "Invalid input file; non-integer height \""
+                      << line.str() << "\"" << std::endl;
+            return false;
+        }
+
+        std::unordered_map<std::string, int> indices;   // node name -> index in world.nodes
+
+        reader.nextLine(line);  // VERTICES
+        while (reader.nextMeaningfulLine(line)) {
+            // "Hobbiton;147;86"
+            splitSpan(line, ';', tokens);
+            if (tokens.size() >= 1 && (tokens[0].equals("ARCS") || tokens[0].equals("EDGES"))) {
+                break;
+            } else if (tokens.size() < 3) {
+                continue;
+            }
+
+            std::string name = trimSpan(tokens[0]).str();
+            if (indices.count(name)) {
+                std::cerr << "Invalid input file; duplicate vertex \""
+                          << name << "\"" << std::endl;
+                return false;
+            }
+
+            int vertexX, vertexY;
+            if (!parseInteger(tokens[1], vertexX) || !parseInteger(tokens[2], vertexY)) {
+                std::cerr << "Invalid input file; non-integer coordinates for vertex \""
+                          << name << "\"" << std::endl;
+                return false;
+            }
+            if (vertexX < 0 || vertexY < 0) {
+                std::cerr << "Invalid input file; negative coordinates for vertex \""
+                          << name << "\"" << std::endl;
+                return false;
+            }
+
+            indices.emplace(name, world.nodes.size());
+            world.nodes.push_back({name, vertexX, vertexY});
+        }
+
+        while (reader.nextMeaningfulLine(line)) {
+            // "Hobbiton;Southfarthing;1"
+            splitSpan(line, ';', tokens);
+            if (tokens.size() < 3) {
+                break;
+            }
+            std::string name1 = trimSpan(tokens[0]).str();
+            std::string name2 = trimSpan(tokens[1]).str();
+
+            auto node1 = indices.find(name1);
+            if (node1 == indices.end()) {
+                std::cerr << "Invalid input file; when reading edge between \""
+                          << name1 << "\" and \"" << name2
+                          << "\", graph does not contain a vertex named \""
+                          << name1 << "\"" << std::endl;
+                return false;
+            }
+            auto node2 = indices.find(name2);
+            if (node2 == indices.end()) {
+                std::cerr << "Invalid input file; when reading edge between \""
+                          << name1 << "\" and \"" << name2
+                          << "\", graph does not contain a vertex named \""
+                          << name2 << "\"" << std::endl;
+                return false;
+            }
+
+            double weight;
+            if (!parseReal(tokens[2], weight)) {
+                std::cerr << "Invalid input file; non-numeric weight for edge between \""
+                          << name1 << "\" and \"" << name2 << "\"" << std::endl;
+                return false;
+            }
+            if (weight < 0) {
+                std::cerr << "Invalid input file; negative weight for edge between \""
+                          << name1 << "\" and \"" << name2 << "\"" << std::endl;
+                return false;
+            }
+
+            // edges are undirected (both ways) by default
+            bool directed = tokens.size() >= 4 && tokens[3].equals("true");
+
+            /* Add the forward edge, and the reverse edge if the road is undirected. */
+            world.edges.push_back({node1->second, node2->second, weight});
+            if (!directed) {
+                world.edges.push_back({node2->second, node1->second, weight});
+            }
+        }
+
+        return true;
+    }
+
+    /*
+     * Adds the parsed nodes and edges to the graph, in file order.
+     */
+    void buildGraph(const WorldData& world, Graph<RoadNode, RoadEdge>& graph) {
+        std::vector<RoadNode*> nodes;
+        nodes.reserve(world.nodes.size());
+        for (const WorldNode& node : world.nodes) {
+            nodes.push_back(new RoadNode(node.name, {node.x, node.y}));
+            graph.addNode(nodes.back());
+        }
+        for (const WorldEdge& edge : world.edges) {
+            graph.addArc(new RoadEdge(nodes[edge.from], nodes[edge.to], edge.cost));
+        }
+    }
+
+    /*
+     * The binary world format, all in the byte order of the machine that wrote it:
+     *     CacheHeader
+     *     CacheNode[nodeCount]
+     *     CacheEdge[edgeCount]
+     *     image file name (imageNameLength bytes)
+     *     node names (namesLength bytes; see CacheNode)
+     * Every section starts at a multiple of 8 bytes, so a mapped file can be read in
+     * place.  The cache of a text world file records the hash and size of the text it was
+     * made from; a binary world file written by writeBinaryWorldFile has no source and
+     * records zero for both.
+     */
+    const char CACHE_MAGIC[8] = {'T', 'B', 'W', 'O', 'R', 'L', 'D', '\0'};
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t largeMapDisplay;
+        uint64_t sourceHash;         // hashSource() of the world file the cache was made from
+        uint64_t sourceSize;
+        int32_t width;
+        int32_t height;
+        uint32_t nodeCount;
+        uint32_t edgeCount;
+        uint32_t imageNameLength;
+        uint32_t namesLength;
+    };
+
+    struct CacheNode {
+        int32_t x;
+        int32_t y;
+        uint32_t nameOffset;         // start of the name within the node names
+        uint32_t nameLength;
+    };
+
+    struct CacheEdge {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    /* Returns the 64-bit FNV-1a hash of the given bytes. */
+    uint64_t hashSource(const char* data, size_t size) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t ii = 0; ii < size; ii++) {
+            hash ^= (unsigned char) data[ii];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /* Returns whether the bytes start like a world in the binary format. */
+    bool isBinaryWorld(const char* data, size_t size) {
+        return size >= sizeof(CacheHeader) && memcmp(data, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0;
+    }
+
+    /*
+     * Loads a world in the binary format from the given bytes, which must be 8-byte
+     * aligned.  Returns false if they are not an intact world of the current version.
+     */
+    bool parseWorldBinary(const char* data, size_t size, WorldData& world) {
+        if (!isBinaryWorld(data, size)) {
+            return false;
+        }
+
+        const CacheHeader* header = reinterpret_cast<const CacheHeader*>(data);
+        if (header->version != CACHE_VERSION) {
+            return false;
+        }
+
+        uint64_t expectedSize = sizeof(CacheHeader)
+                + uint64_t(header->nodeCount) * sizeof(CacheNode)
+                + uint64_t(header->edgeCount) * sizeof(CacheEdge)
+                + header->imageNameLength + header->namesLength;
+        if (size != expectedSize) {
+            return false;
+        }
+
+        const CacheNode* nodes = reinterpret_cast<const CacheNode*>(header + 1);
+        const CacheEdge* edges = reinterpret_cast<const CacheEdge*>(nodes + header->nodeCount);
+        const char* imageName = reinterpret_cast<const char*>(edges + header->edgeCount);
+        const char* names = imageName + header->imageNameLength;
+
+        world.header.largeMapDisplay = header->largeMapDisplay != 0;
+        world.header.imageFile.assign(imageName, header->imageNameLength);
+        world.header.width = header->width;
+        world.header.height = header->height;
+
+        world.nodes.resize(header->nodeCount);
+        for (uint32_t ii = 0; ii < header->nodeCount; ii++) {
+            const CacheNode& node = nodes[ii];
+            if (uint64_t(node.nameOffset) + node.nameLength > header->namesLength) {
+                return false;
+            }
+            world.nodes[ii] = {std::string(names + node.nameOffset, node.nameLength), node.x, node.y};
+        }
+
+        world.edges.resize(header->edgeCount);
+        for (uint32_t ii = 0; ii < header->edgeCount; ii++) {
+            const CacheEdge& edge = edges[ii];
+            if (edge.from >= header->nodeCount || edge.to >= header->nodeCount) {
+                return false;
+            }
+            world.edges[ii] = {int(edge.from), int(edge.to), edge.cost};
+        }
+
+        return true;
+    }
+
+    /*
+     * Parses a world file in either format. On failure, prints a message to cerr and
+     * returns false.
+     */
+    bool parseWorld(const char* begin, const char* end, WorldData& world) {
+        if (!isBinaryWorld(begin, end - begin)) {
+            return parseWorldText(begin, end, world);
+        }
+        if (!parseWorldBinary(begin, end - begin, world)) {
+            std::cerr << "Invalid input file; damaged or outdated binary world" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /*
+     * Loads the cache if it exists, is intact, and was made from a source with the given
+     * hash and size.
+     */
+    bool readCache(const std::string& cacheFilename, uint64_t sourceHash, uint64_t sourceSize,
+                   WorldData& world) {
+        MappedFile cache(cacheFilename);
+        if (!cache.isOpen() || !isBinaryWorld(cache.data(), cache.size())) {
+            return false;
+        }
+
+        const CacheHeader* header = reinterpret_cast<const CacheHeader*>(cache.data());
+        if (header->sourceHash != sourceHash || header->sourceSize != sourceSize) {
+            return false;
+        }
+        return parseWorldBinary(cache.data(), cache.size(), world);
+    }
+
+    /*
+     * Writes the world in the binary format, recording the hash and size of the text it
+     * was read from.  The file is written under a temporary name and renamed into place, so
+     * a reader never sees it half written.  Returns false, leaving no new file behind, if
+     * the file cannot be written.
+     */
+    bool writeBinary(const std::string& filename, uint64_t sourceHash, uint64_t sourceSize,
+                     const WorldData& world) {
+        CacheHeader header;
+        memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = CACHE_VERSION;
+        header.largeMapDisplay = world.header.largeMapDisplay;
+        header.sourceHash = sourceHash;
+        header.sourceSize = sourceSize;
+        header.width = world.header.width;
+        header.height = world.header.height;
+        header.nodeCount = world.nodes.size();
+        header.edgeCount = world.edges.size();
+        header.imageNameLength = world.header.imageFile.size();
+
+        std::vector<CacheNode> nodes;
+        std::string names;
+        nodes.reserve(world.nodes.size());
+        for (const WorldNode& node : world.nodes) {
+            nodes.push_back({node.x, node.y, uint32_t(names.size()), uint32_t(node.name.size())});
+            names += node.name;
+        }
+        header.namesLength = names.size();
+
+        std::vector<CacheEdge> edges;
+        edges.reserve(world.edges.size());
+        for (const WorldEdge& edge : world.edges) {
+            edges.push_back({uint32_t(edge.from), uint32_t(edge.to), edge.cost});
+        }
+
+        std::string temporaryName = filename + ".tmp";
+        std::ofstream output(temporaryName.c_str(), std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(CacheNode));
+        output.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(CacheEdge));
+        output.write(world.header.imageFile.data(), world.header.imageFile.size());
+        output.write(names.data(), names.size());
+        output.close();
+        if (output.fail()) {
+            std::remove(temporaryName.c_str());
+            return false;
+        }
+
+        // Another process may have the old file mapped; renaming leaves that mapping intact
+#if defined(_WIN32)
+        std::remove(filename.c_str());    // rename() does not replace existing files on Windows
+#endif
+        if (std::rename(temporaryName.c_str(), filename.c_str()) != 0) {
+            std::remove(temporaryName.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /*
+     * Appends the cost to the text, using the fewest digits (15 or 17) that read back as
+     * exactly the same double.
+     */
+    void appendCost(std::string& text, double cost) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.15g", cost);
+        if (strtod(buffer, nullptr) != cost) {
+            snprintf(buffer, sizeof(buffer), "%.17g", cost);
+        }
+        text += buffer;
+    }
+
+    static_assert(sizeof(CacheHeader) % 8 == 0 && sizeof(CacheNode) % 8 == 0 && sizeof(CacheEdge) % 8 == 0,
+                  "cache sections must stay 8-byte aligned");
+}
+
+bool readWorldFile(std::istream& input, WorldFileHeader& header, Graph<RoadNode, RoadEdge>& graph) {
+    std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    WorldData world;
+    bool parsed = parseWorld(text.data(), text.data() + text.size(), world);
+    header = world.header;
+    if (parsed) {
+        buildGraph(world, graph);
+    }
+    return parsed;
+}
+
+bool readWorldFile(const std::string& filename, WorldFileHeader& header, Graph<RoadNode, RoadEdge>& graph) {
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    WorldData world;
+    bool parsed = parseWorld(file.data(), file.data() + file.size(), world);
+    header = world.header;
+    if (parsed) {
+        buildGraph(world, graph);
+    }
+    return parsed;
+}
+
+/*
+ * A binary world file is already in the cache format, so it is read directly rather
+ * than cached again.
+ */
+bool readWorldFileCached(const std::string& filename, const std::string& cacheFilename,
+                         WorldFileHeader& header, Graph<RoadNode, RoadEdge>& graph) {
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    WorldData world;
+    if (isBinaryWorld(file.data(), file.size())) {
+        bool parsed = parseWorld(file.data(), file.data() + file.size(), world);
+        header = world.header;
+        if (parsed) {
+            buildGraph(world, graph);
+        }
+        return parsed;
+    }
+
+    uint64_t sourceHash = hashSource(file.data(), file.size());
+    if (!readCache(cacheFilename, sourceHash, file.size(), world)) {
+        world = WorldData();
+        if (!parseWorldText(file.data(), file.data() + file.size(), world)) {
+            header = world.header;
+            return false;
+        }
+        // Failing to write the cache is not an error, since the next load simply parses the text again
+        writeBinary(cacheFilename, sourceHash, file.size(), world);
+    }
+    header = world.header;
+    buildGraph(world, graph);
+    return true;
+}
+
+/*
+ * The text is built in memory in one piece, which keeps writing millions of lines fast.
+ * Two-way roads become two consecutive edges when read, so any edge followed by its exact
+ * reverse is written back as a single undirected road.
+ */
+bool writeWorldFile(const std::string& filename, const WorldData& world) {
+    std::string text;
+    if (world.header.largeMapDisplay) {
+        text += "FLAGS\nlargeMapDisplay=true\n";
+    }
+    text += "IMAGE\n" + world.header.imageFile + "\n"
+            + std::to_string(world.header.width) + "\n"
+            + std::to_string(world.header.height) + "\n";
+
+    text += "VERTICES\n";
+    for (const WorldNode& node : world.nodes) {
+        text += node.name + ";" + std::to_string(node.x) + ";" + std::to_string(node.y) + "\n";
+    }
+
+    text += "EDGES\n";
+    for (size_t ii = 0; ii < world.edges.size(); ii++) {
+        const WorldEdge& edge = world.edges[ii];
+        bool twoWay = ii + 1 < world.edges.size()
+                && world.edges[ii + 1].from == edge.to
+                && world.edges[ii + 1].to == edge.from
+                && world.edges[ii + 1].cost == edge.cost;
+        text += world.nodes[edge.from].name + ";" + world.nodes[edge.to].name + ";";
+        appendCost(text, edge.cost);
+        if (twoWay) {
+            text += "\n";
+            ii++;
+        } else {
+            text += ";true\n";
+        }
+    }
+
+    std::ofstream output(filename.c_str(), std::ios::binary | std::ios::trunc);
+    output.write(text.data(), text.size());
+    output.close();
+    if (output.fail()) {
+        std::remove(filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool writeBinaryWorldFile(const std::string& filename, const WorldData& world) {
+    return writeBinary(filename, 0, 0, world);
+}
@@ -0,0 +1,92 @@
+/*
+ * This header declares readWorldFile, which parses the world (map) files used by
+ * Trailblazer into a Graph<RoadNode, RoadEdge> without needing a graphical window.
+ * WorldDisplay uses it to read the maps it draws, and the command-line tools in
+ * ../tools use it to load maps headlessly.
+ *
+ * A world file is either the text format that the provided maps use or a binary format,
+ * the one readWorldFileCached keeps its caches in; the readers tell them apart by the
+ * first bytes of the file.  Programs that make worlds rather than read them fill in a
+ * WorldData and write it out with writeWorldFile or writeBinaryWorldFile.
+ */
+
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+#include "graph.h"
+#include "RoadGraph.h"
+
+/*
+ * The display settings stored in the header of a world file.
+ */
+struct WorldFileHeader {
+    bool largeMapDisplay = false;   // whether the map should be drawn in "large map mode"
+    std::string imageFile;          // background image drawn behind the map
+    int width = 0;                  // preferred width / height of the map in pixels
+    int height = 0;
+};
+
+/*
+ * A world held as flat arrays, with edges referring to nodes by their index.  Every edge
+ * is one-way, so a two-way road is two edges; the readers store them next to each other.
+ * Coordinates are in pixels and may not be negative.
+ */
+struct WorldNode {
+    std::string name;
+    int x;
+    int y;
+};
+
+struct WorldEdge {
+    int from;
+    int to;
+    double cost;
+};
+
+struct WorldData {
+    WorldFileHeader header;
+    std::vector<WorldNode> nodes;
+    std::vector<WorldEdge> edges;
+};
+
+/*
+ * Reads a world file from the given stream, filling in its header and adding its nodes
+ * and edges to the given (empty) graph. On failure, prints a message to cerr and returns
+ * false; the graph may then hold part of the world.
+ */
+bool readWorldFile(std::istream& input, WorldFileHeader& header, Graph<RoadNode, RoadEdge>& graph);
+
+/*
+ * Reads a world file from the file with the given name, like readWorldFile(istream&, ...).
+ * Returns false if the file cannot be opened.
+ */
+bool readWorldFile(const std::string& filename, WorldFileHeader& header, Graph<RoadNode, RoadEdge>& graph);
+
+/*
+ * Reads a world file like readWorldFile(), using a binary cache of the parsed world in the
+ * file named cacheFilename.  The cache is keyed by a hash of the world file's contents: if
+ * it exists and was made from the file as it is now, it is loaded in place of parsing the
+ * text, and otherwise the text is parsed and the cache is (re)written.  The cache holds
+ * flat arrays that can be read straight out of a memory-mapped file; it is only valid on
+ * machines with the same byte order as the one that wrote it.  A world file that is
+ * already binary is simply read, without a cache.
+ */
+bool readWorldFileCached(const std::string& filename, const std::string& cacheFilename,
+                         WorldFileHeader& header, Graph<RoadNode, RoadEdge>& graph);
+
+/*
+ * Writes the world to the file with the given name in the text format.  An edge followed
+ * directly by its reverse at the same cost is written as one undirected road, and every
+ * other edge as a directed one.  Returns false if the file cannot be written.
+ */
+bool writeWorldFile(const std::string& filename, const WorldData& world);
+
+/*
+ * Writes the world to the file with the given name in the binary format, which loads far
+ * faster than the text and can be read in place from a memory-mapped file.  Like the cache
+ * it is only readable on machines with the same byte order.  Returns false if the file
+ * cannot be written.
+ */
+bool writeBinaryWorldFile(const std::string& filename, const WorldData& world);
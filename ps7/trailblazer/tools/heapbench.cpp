@@ -0,0 +1,172 @@
+/*
+ * Command-line benchmark comparing the arity of the IndexedHeap that Dijkstra's algorithm
+ * and A* use as their open set.  For every world file given on the command line, it picks
+ * the same pseudo-random start / end pairs for every arity, runs both searches, and prints
+ * the average time per query.  It also checks that every arity finds paths of the same cost.
+ *
+ * Usage: heapbench [-queries N] [-seed S] [-cache] world-file ...
+ *
+ * With -cache, each world is loaded through a binary cache kept next to it in
+ * <world-file>.cache (see readWorldFileCached in WorldFile.h).
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "graph.h"
+#include "CompactRoadGraph.h"
+#include "RoadGraph.h"
+#include "Trailblazer.h"
+#include "WorldFile.h"
+using namespace std;
+
+/* Arities compared by the benchmark. */
+static const int ARITIES[] = {2, 3, 4, 8, 16};
+
+static const int DEFAULT_NUM_QUERIES = 200;
+static const unsigned DEFAULT_SEED = 106;
+
+/* Signature shared by dijkstrasAlgorithm and aStar. */
+using SearchFunction = Path (*)(const RoadGraph&, RoadNode*, RoadNode*, const SearchOptions&);
+
+/*
+ * Returns the cost of a path, or -1 for the empty path.
+ */
+double pathCost(const RoadGraph& graph, const Path& path) {
+
+    if (path.isEmpty()) {
+        return -1;
+    }
+
+    double cost = 0.0;
+    for (int ii = 1; ii < path.size(); ii++) {
+        cost += graph.edgeBetween(path[ii - 1], path[ii])->cost();
+    }
+    return cost;
+}
+
+/*
+ * Runs every query through the search with the given arity, recording the path costs in
+ * costs, and returns the average time per query in microseconds.
+ */
+double timeSearch(const RoadGraph& graph, SearchFunction search, int arity,
+                  const vector<pair<RoadNode*, RoadNode*>>& queries, vector<double>& costs) {
+
+    SearchOptions options;
+    options.heapArity = arity;
+    options.headless = true;
+    costs.clear();
+
+    auto startTime = chrono::steady_clock::now();
+    for (const auto& query : queries) {
+        Path path = search(graph, query.first, query.second, options);
+        costs.push_back(pathCost(graph, path));
+    }
+    auto endTime = chrono::steady_clock::now();
+
+    return chrono::duration<double, micro>(endTime - startTime).count() / queries.size();
+}
+
+/*
+ * Benchmarks one search function at every arity and prints a row per arity.
+ */
+void benchmarkSearch(const string& name, const RoadGraph& graph, SearchFunction search,
+                     const vector<pair<RoadNode*, RoadNode*>>& queries) {
+
+    vector<double> referenceCosts;
+    vector<double> costs;
+
+    for (int arity : ARITIES) {
+        double micros = timeSearch(graph, search, arity, queries, costs);
+
+        // Every arity must find equally cheap paths; only the speed may differ
+        bool costsMatch = true;
+        if (referenceCosts.empty()) {
+            referenceCosts = costs;
+        }
+        for (size_t ii = 0; ii < costs.size(); ii++) {
+            if (fabs(costs[ii] - referenceCosts[ii]) > 1e-9 * fmax(1.0, referenceCosts[ii])) {
+                costsMatch = false;
+            }
+        }
+
+        cout << "  " << setw(10) << left << name
+             << " arity " << setw(3) << arity
+             << setw(12) << right << fixed << setprecision(1) << micros << " us/query"
+             << (costsMatch ? "" : "   COST MISMATCH") << endl;
+    }
+}
+
+int main(int argc, char** argv) {
+
+    int numQueries = DEFAULT_NUM_QUERIES;
+    unsigned seed = DEFAULT_SEED;
+    bool useCache = false;
+    vector<string> worldFiles;
+
+    for (int ii = 1; ii < argc; ii++) {
+        string arg = argv[ii];
+        if (arg == "-queries" and ii + 1 < argc) {
+            numQueries = atoi(argv[++ii]);
+        }
+        else if (arg == "-seed" and ii + 1 < argc) {
+            seed = strtoul(argv[++ii], nullptr, 10);
+        }
+        else if (arg == "-cache") {
+            useCache = true;
+        }
+        else {
+            worldFiles.push_back(arg);
+        }
+    }
+
+    if (worldFiles.empty() or numQueries <= 0) {
+        cerr << "Usage: " << argv[0] << " [-queries N] [-seed S] [-cache] world-file ..." << endl;
+        return 1;
+    }
+
+    for (const string& worldFile : worldFiles) {
+
+        WorldFileHeader header;
+        Graph<RoadNode, RoadEdge> data;
+        bool loaded = useCache ? readWorldFileCached(worldFile, worldFile + ".cache", header, data)
+                               : readWorldFile(worldFile, header, data);
+        if (!loaded) {
+            cerr << worldFile << " is not a valid world file." << endl;
+            return 1;
+        }
+
+        RoadGraph graph(&data);
+        const CompactRoadGraph& compact = graph.compact();
+        if (compact.nodeCount() == 0) {
+            cerr << worldFile << " has no nodes." << endl;
+            return 1;
+        }
+
+        // The same seed gives the same queries for every arity and every run
+        mt19937 random(seed);
+        uniform_int_distribution<int> pickNode(0, compact.nodeCount() - 1);
+        vector<pair<RoadNode*, RoadNode*>> queries;
+        for (int ii = 0; ii < numQueries; ii++) {
+            RoadNode* start = compact.nodeAt(pickNode(random));
+            RoadNode* end = compact.nodeAt(pickNode(random));
+            queries.push_back({start, end});
+        }
+
+        cout << worldFile << ": " << compact.nodeCount() << " nodes, "
+             << compact.edgeCount() << " edges, " << numQueries << " queries" << endl;
+
+        SearchFunction dijkstra = dijkstrasAlgorithm;
+        SearchFunction astar = aStar;
+        benchmarkSearch("Dijkstra", graph, dijkstra, queries);
+        benchmarkSearch("A*", graph, astar, queries);
+        cout << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Headless command-line driver for the Trailblazer path searches.  It loads a world file,
+ * runs one of the algorithms from Trailblazer.h between two named locations, and prints
+ * the resulting path along with its cost, the time the search took and the work it did
+ * (see SearchCounters.h).  The searches run headless, since there is no display to color.
+ *
+ * Usage: routefinder [-index index-file] world-file algorithm start-name end-name
+ *
+ * With -index, the preprocessing used by the "ch", "alt" and "arcflags" algorithms is
+ * loaded from the given routing index (see RoutingIndex.h) when it holds some for this
+ * world, and is otherwise built and then saved to it, so that later runs skip it.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "graph.h"
+#include "ArcFlags.h"
+#include "ContractionHierarchy.h"
+#include "Landmarks.h"
+#include "RoadGraph.h"
+#include "RoutingIndex.h"
+#include "Trailblazer.h"
+#include "WorldFile.h"
+using namespace std;
+
+/* Signature shared by the variants of the searches in Trailblazer.h that take options. */
+using SearchFunction = Path (*)(const RoadGraph&, RoadNode*, RoadNode*, const SearchOptions&);
+
+/* Preprocessed data used by the "ch", "alt" and "arcflags" algorithms, loaded or built before the timed search starts. */
+static const ContractionHierarchy* hierarchy = nullptr;
+static const Landmarks* landmarks = nullptr;
+static const ArcFlags* arcFlags = nullptr;
+
+/*
+ * Answers the query with the preprocessed contraction hierarchy.
+ */
+Path contractionHierarchySearch(const RoadGraph&, RoadNode* start, RoadNode* end, const SearchOptions& options) {
+    return hierarchy->shortestPath(start, end, options);
+}
+
+/*
+ * Runs A* with the landmark (ALT) heuristic.
+ */
+Path landmarkAStar(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options) {
+    SearchOptions landmarkOptions = options;
+    landmarkOptions.landmarks = landmarks;
+    return aStar(graph, start, end, landmarkOptions);
+}
+
+/*
+ * Runs Dijkstra's algorithm, pruned by the arc flags.
+ */
+Path arcFlagsDijkstra(const RoadGraph& graph, RoadNode* start, RoadNode* end, const SearchOptions& options) {
+    SearchOptions arcFlagsOptions = options;
+    arcFlagsOptions.arcFlags = arcFlags;
+    return dijkstrasAlgorithm(graph, start, end, arcFlagsOptions);
+}
+
+/*
+ * The algorithms that can be selected on the command line.
+ */
+struct Algorithm {
+    string name;
+    SearchFunction search;
+};
+
+static const Algorithm ALGORITHMS[] = {
+    {"bfs",        breadthFirstSearch},
+    {"dijkstra",   dijkstrasAlgorithm},
+    {"astar",      aStar},
+    {"bidijkstra", bidirectionalDijkstra},
+    {"biastar",    bidirectionalAStar},
+    {"alternative", alternativeRoute},
+    {"alt",        landmarkAStar},
+    {"ch",         contractionHierarchySearch},
+    {"arcflags",   arcFlagsDijkstra},
+};
+
+/*
+ * Prints the usage message, including the list of algorithm names.
+ */
+void usage(const string& program) {
+    cerr << "Usage: " << program << " [-index index-file] world-file algorithm start-name end-name" << endl;
+    cerr << "Algorithms:";
+    for (const Algorithm& algorithm : ALGORITHMS) {
+        cerr << " " << algorithm.name;
+    }
+    cerr << endl;
+}
+
+int main(int argc, char** argv) {
+
+    string indexFile;
+    int firstArg = 1;
+    if (argc == 7 and string(argv[1]) == "-index") {
+        indexFile = argv[2];
+        firstArg = 3;
+    }
+    if (argc - firstArg != 4) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    string worldFile = argv[firstArg];
+    string algorithmName = argv[firstArg + 1];
+
+    const Algorithm* algorithm = nullptr;
+    for (const Algorithm& candidate : ALGORITHMS) {
+        if (candidate.name == algorithmName) {
+            algorithm = &candidate;
+        }
+    }
+    if (algorithm == nullptr) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    WorldFileHeader header;
+    Graph<RoadNode, RoadEdge> data;
+    if (!readWorldFile(worldFile, header, data)) {
+        cerr << worldFile << " is not a valid world file." << endl;
+        return 1;
+    }
+
+    RoadNode* start = data.getNode(argv[firstArg + 2]);
+    RoadNode* end = data.getNode(argv[firstArg + 3]);
+    if (start == nullptr or end == nullptr) {
+        cerr << "The world does not contain a location named \""
+             << (start == nullptr ? argv[firstArg + 2] : argv[firstArg + 3]) << "\"" << endl;
+        return 1;
+    }
+
+    RoadGraph graph(&data);
+    RoutingIndex index(graph);
+    if (!indexFile.empty()) {
+        auto loadStart = chrono::steady_clock::now();
+        bool loaded = index.load(indexFile);
+        auto loadEnd = chrono::steady_clock::now();
+        if (loaded) {
+            cout << "Index load time: " << chrono::duration<double, milli>(loadEnd - loadStart).count()
+                 << " ms" << endl;
+        }
+    }
+
+    bool built = false;
+    if (algorithm->search == contractionHierarchySearch) {
+        if (index.contractionHierarchy() == nullptr) {
+            auto prepStart = chrono::steady_clock::now();
+            index.setContractionHierarchy(new ContractionHierarchy(graph));
+            auto prepEnd = chrono::steady_clock::now();
+            cout << "Preprocessing time: " << chrono::duration<double, milli>(prepEnd - prepStart).count()
+                 << " ms (" << index.contractionHierarchy()->shortcutCount() << " shortcuts)" << endl;
+            built = true;
+        }
+        hierarchy = index.contractionHierarchy();
+    }
+    else if (algorithm->search == landmarkAStar) {
+        if (index.landmarks() == nullptr) {
+            auto prepStart = chrono::steady_clock::now();
+            index.setLandmarks(new Landmarks(graph));
+            auto prepEnd = chrono::steady_clock::now();
+            cout << "Preprocessing time: " << chrono::duration<double, milli>(prepEnd - prepStart).count()
+                 << " ms (" << index.landmarks()->count() << " landmarks)" << endl;
+            built = true;
+        }
+        landmarks = index.landmarks();
+    }
+    else if (algorithm->search == arcFlagsDijkstra) {
+        if (index.arcFlags() == nullptr) {
+            auto prepStart = chrono::steady_clock::now();
+            index.setArcFlags(new ArcFlags(graph));
+            auto prepEnd = chrono::steady_clock::now();
+            cout << "Preprocessing time: " << chrono::duration<double, milli>(prepEnd - prepStart).count()
+                 << " ms (" << index.arcFlags()->regionCount() << " regions)" << endl;
+            built = true;
+        }
+        arcFlags = index.arcFlags();
+    }
+    if (built and !indexFile.empty() and !index.save(indexFile)) {
+        cerr << "Could not write the index to " << indexFile << endl;
+    }
+
+    SearchCounters counters;
+    SearchOptions options;
+    options.headless = true;
+    options.counters = &counters;
+
+    auto startTime = chrono::steady_clock::now();
+    Path path = algorithm->search(graph, start, end, options);
+    auto endTime = chrono::steady_clock::now();
+
+    if (path.isEmpty()) {
+        cout << "No path was found." << endl;
+        return 0;
+    }
+
+    double cost = 0.0;
+    for (int ii = 0; ii < path.size(); ii++) {
+        if (ii > 0) {
+            cost += graph.edgeBetween(path[ii - 1], path[ii])->cost();
+            cout << " -> ";
+        }
+        cout << path[ii]->nodeName();
+    }
+    cout << endl;
+
+    cout << "Path length: " << path.size() << endl;
+    cout << "Path cost: " << cost << endl;
+    cout << "Search time: " << chrono::duration<double, milli>(endTime - startTime).count() << " ms" << endl;
+    cout << "Nodes settled: " << counters.settled << " (fringe updates: " << counters.fringe << ")" << endl;
+    cout << "Edges relaxed: " << counters.relaxed << endl;
+    cout << "Open set: " << counters.pushes << " pushes, " << counters.pops << " pops, "
+         << counters.decreaseKeys << " decrease-keys, peak size " << counters.peakOpenSet << endl;
+    cout << "Search statistics: " << counters.toJson() << endl;
+    return 0;
+}
@@ -0,0 +1,482 @@
+/*
+ * Headless benchmark for the Trailblazer path searches.  It loads a world file, builds a
+ * workload of start / end pairs, and runs every query through breadth-first search,
+ * Dijkstra's algorithm, A* and alternativeRoute.  For each algorithm it prints the
+ * latency percentiles, the throughput and the average work per query (see
+ * SearchCounters.h); with -csv it prints the same figures as CSV rows instead.
+ *
+ * Every path is also checked against the one Dijkstra's algorithm found for the same
+ * query: it must be a real path from the start to the end that visits no location twice,
+ * A* must find one that is just as cheap, and breadth-first search and the alternative
+ * route may not find a cheaper one (or, for breadth-first search, miss one).  The program
+ * exits with status 2 if any check fails, so it can be used as a regression test for
+ * changes to the search code.  culdesac.txt and culdesac-pairs.txt in this directory are
+ * a small world and query that exercise the alternative route's loop check.
+ *
+ * Usage: searchbench [-queries N] [-seed S] [-pairs file] [-warmup N] [-cache] [-profiles] [-csv] world-file
+ *
+ * The queries are pseudo-random pairs of nodes, the same for the same seed, unless -pairs
+ * names a file with one "start-name end-name" pair per line.  -warmup runs that many
+ * queries through each algorithm before timing it.  With -cache the world is loaded
+ * through a binary cache kept next to it in <world-file>.cache.
+ *
+ * With -profiles, every edge is also given a rush-hour travel-time profile (see
+ * TravelTimeProfiles.h) and each query is run, at a pseudo-random departure time, through
+ * earliestArrivalDijkstra and earliestArrivalAStar.  Their paths must be real paths, must
+ * arrive (by TravelTimeProfiles::arrivalTime) at the same time as each other, and no later
+ * than the path Dijkstra's algorithm finds on the ordinary costs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "graph.h"
+#include "CompactRoadGraph.h"
+#include "RoadGraph.h"
+#include "Trailblazer.h"
+#include "TravelTimeProfiles.h"
+#include "WorldFile.h"
+using namespace std;
+
+static const int DEFAULT_NUM_QUERIES = 200;
+static const unsigned DEFAULT_SEED = 106;
+
+/*
+ * Relative tolerance for comparing A* costs with Dijkstra's.  The crow-fly heuristic is not
+ * quite admissible: pointDistance() and edgeRate() in RoadGraph.cpp each subtract 1 from
+ * an edge's length, so the top road speed comes out a little low and the bound can exceed
+ * the true travel time by a pixel or two's worth at that speed.  A* may therefore, very
+ * rarely, return a path that is a tiny fraction more expensive; anything beyond that is a
+ * regression.
+ */
+static const double COST_TOLERANCE = 1e-4;
+
+/*
+ * The rush-hour profile used by -profiles: the factor climbs from 1 to RUSH_HOUR_FACTOR
+ * over the first 30% of the period and falls back over the next 10%.  The period is this
+ * many times the largest edge cost, which keeps the fall gentle enough for every edge to
+ * stay FIFO.
+ */
+static const double RUSH_HOUR_FACTOR = 2.0;
+static const double PERIOD_PER_EDGE_COST = 20.0;
+
+/* Exit status when a path fails one of the checks. */
+static const int CHECK_FAILED = 2;
+
+/* Signature shared by the variants of the searches in Trailblazer.h that take options. */
+using SearchFunction = Path (*)(const RoadGraph&, RoadNode*, RoadNode*, const SearchOptions&);
+
+/* One query of the workload. */
+using Query = pair<RoadNode*, RoadNode*>;
+
+/*
+ * How the paths of an algorithm are checked against the costs Dijkstra's algorithm found.
+ */
+enum CostCheck {
+    REFERENCE,      // this is Dijkstra's algorithm, which the others are checked against
+    SAME_COST,      // must find a path exactly when Dijkstra does, at the same cost
+    NOT_CHEAPER,    // must find a path exactly when Dijkstra does, at no lower cost
+    OPTIONAL_PATH   // may find no path, but any path found must cost no less
+};
+
+/*
+ * The algorithms benchmarked, in the order they run.  Dijkstra's algorithm goes first
+ * because the others are checked against it.
+ */
+struct Algorithm {
+    string name;
+    SearchFunction search;
+    CostCheck check;
+};
+
+static const Algorithm ALGORITHMS[] = {
+    {"dijkstra",    dijkstrasAlgorithm, REFERENCE},
+    {"bfs",         breadthFirstSearch, NOT_CHEAPER},
+    {"astar",       aStar,              SAME_COST},
+    {"alternative", alternativeRoute,   OPTIONAL_PATH},
+};
+
+/*
+ * Returns the cost of a path, or -1 for the empty path.  Also returns -1 if consecutive
+ * nodes are not joined by an edge, the path does not run from start to end, or it visits a
+ * node twice, after setting valid to false.
+ */
+double pathCost(const RoadGraph& graph, const Path& path, const Query& query, bool& valid) {
+
+    valid = true;
+    if (path.isEmpty()) {
+        return -1;
+    }
+    if (path[0] != query.first or path[path.size() - 1] != query.second) {
+        valid = false;
+        return -1;
+    }
+
+    double cost = 0.0;
+    for (int ii = 1; ii < path.size(); ii++) {
+        RoadEdge* edge = graph.edgeBetween(path[ii - 1], path[ii]);
+        if (edge == nullptr) {
+            valid = false;
+            return -1;
+        }
+        cost += edge->cost();
+    }
+
+    vector<RoadNode*> nodes;
+    for (RoadNode* node : path) {
+        nodes.push_back(node);
+    }
+    sort(nodes.begin(), nodes.end());
+    if (adjacent_find(nodes.begin(), nodes.end()) != nodes.end()) {
+        valid = false;
+        return -1;
+    }
+    return cost;
+}
+
+/*
+ * Returns whether a path of the given cost passes the algorithm's check against the cost
+ * Dijkstra's algorithm found (-1 meaning that neither found a path).
+ */
+bool costPassesCheck(CostCheck check, double cost, double referenceCost) {
+
+    if (check == REFERENCE) {
+        return true;
+    }
+    if (cost < 0 or referenceCost < 0) {
+        return (cost < 0 and referenceCost < 0) or (check == OPTIONAL_PATH and cost < 0);
+    }
+
+    double tolerance = COST_TOLERANCE * fmax(1.0, referenceCost);
+    if (check == SAME_COST) {
+        return fabs(cost - referenceCost) <= tolerance;
+    }
+    return cost >= referenceCost - tolerance;
+}
+
+/*
+ * Returns the value below which the given fraction of the sorted latencies fall, using
+ * the nearest-rank method.
+ */
+double percentile(const vector<double>& sortedLatencies, double fraction) {
+    int rank = (int) ceil(fraction * sortedLatencies.size());
+    return sortedLatencies[max(rank, 1) - 1];
+}
+
+/*
+ * Reads the queries from a file with one "start-name end-name" pair per line, skipping
+ * blank lines and lines starting with '#'.  Prints a message to cerr and returns false if
+ * the file cannot be read or names a location the world does not contain.
+ */
+bool readQueries(const string& filename, Graph<RoadNode, RoadEdge>& data, vector<Query>& queries) {
+
+    ifstream input(filename);
+    if (!input) {
+        cerr << "Cannot open " << filename << "." << endl;
+        return false;
+    }
+
+    string line;
+    int lineNumber = 0;
+    while (getline(input, line)) {
+        lineNumber++;
+        istringstream fields(line);
+        string startName, endName;
+        if (!(fields >> startName) or startName[0] == '#') {
+            continue;
+        }
+        if (!(fields >> endName)) {
+            cerr << filename << ":" << lineNumber << ": expected a start and an end name." << endl;
+            return false;
+        }
+
+        RoadNode* start = data.getNode(startName);
+        RoadNode* end = data.getNode(endName);
+        if (start == nullptr or end == nullptr) {
+            cerr << filename << ":" << lineNumber << ": the world does not contain a location named \""
+                 << (start == nullptr ? startName : endName) << "\"" << endl;
+            return false;
+        }
+        queries.push_back({start, end});
+    }
+    return true;
+}
+
+/*
+ * Fills queries with pseudo-random pairs of nodes; the same seed always gives the same pairs.
+ */
+void randomQueries(const CompactRoadGraph& compact, int numQueries, unsigned seed, vector<Query>& queries) {
+
+    mt19937 random(seed);
+    uniform_int_distribution<int> pickNode(0, compact.nodeCount() - 1);
+    for (int ii = 0; ii < numQueries; ii++) {
+        RoadNode* start = compact.nodeAt(pickNode(random));
+        RoadNode* end = compact.nodeAt(pickNode(random));
+        queries.push_back({start, end});
+    }
+}
+
+/*
+ * Runs every query through the algorithm, timing each one separately, and prints its
+ * figures.  The path costs are stored in costs; for any algorithm but Dijkstra's they are
+ * checked against referenceCosts.  Returns the number of queries that failed a check.
+ */
+int benchmarkAlgorithm(const Algorithm& algorithm, const RoadGraph& graph, const vector<Query>& queries,
+                       int numWarmup, bool csv, const vector<double>& referenceCosts, vector<double>& costs) {
+
+    SearchOptions options;
+    options.headless = true;
+    for (int ii = 0; ii < numWarmup; ii++) {
+        const Query& query = queries[ii % queries.size()];
+        algorithm.search(graph, query.first, query.second, options);
+    }
+
+    SearchCounters counters;
+    options.counters = &counters;
+    vector<double> latencies;
+    costs.clear();
+    int failures = 0;
+
+    for (size_t ii = 0; ii < queries.size(); ii++) {
+        const Query& query = queries[ii];
+        auto startTime = chrono::steady_clock::now();
+        Path path = algorithm.search(graph, query.first, query.second, options);
+        auto endTime = chrono::steady_clock::now();
+        latencies.push_back(chrono::duration<double, micro>(endTime - startTime).count());
+
+        bool valid;
+        double cost = pathCost(graph, path, query, valid);
+        costs.push_back(cost);
+        if (!valid or !costPassesCheck(algorithm.check, cost, referenceCosts.empty() ? cost : referenceCosts[ii])) {
+            if (failures == 0) {
+                cerr << algorithm.name << ": query " << ii << " from " << query.first->nodeName()
+                     << " to " << query.second->nodeName()
+                     << (valid ? " has cost " + to_string(cost) + ", expected "
+                                 + to_string(referenceCosts[ii])
+                               : " returned something that is not a path between them") << endl;
+            }
+            failures++;
+        }
+    }
+
+    double totalMicros = 0.0;
+    for (double latency : latencies) {
+        totalMicros += latency;
+    }
+    sort(latencies.begin(), latencies.end());
+    double perQuery = 1.0 / queries.size();
+
+    if (csv) {
+        cout << algorithm.name << "," << queries.size() << "," << totalMicros * perQuery << ","
+             << percentile(latencies, 0.5) << "," << percentile(latencies, 0.9) << ","
+             << percentile(latencies, 0.99) << "," << latencies.back() << ","
+             << queries.size() / (totalMicros / 1e6) << "," << failures << "," << counters.toCsv() << endl;
+        return failures;
+    }
+
+    cout << "  " << setw(12) << left << algorithm.name << right << fixed << setprecision(1)
+         << setw(10) << totalMicros * perQuery
+         << setw(10) << percentile(latencies, 0.5)
+         << setw(10) << percentile(latencies, 0.9)
+         << setw(10) << percentile(latencies, 0.99)
+         << setw(10) << latencies.back()
+         << setw(12) << queries.size() / (totalMicros / 1e6)
+         << setw(11) << counters.settled * perQuery
+         << setw(11) << counters.relaxed * perQuery
+         << (failures == 0 ? "" : "   " + to_string(failures) + " FAILED") << endl;
+    return failures;
+}
+
+/*
+ * Checks the earliest-arrival searches on every query, as described at the top of this
+ * file, against the path Dijkstra's algorithm finds on the ordinary costs.  Prints a
+ * summary unless csv is set, and returns the number of queries that failed.
+ */
+int checkEarliestArrival(const RoadGraph& graph, const vector<Query>& queries, unsigned seed, bool csv) {
+
+    const CompactRoadGraph& compact = graph.compact();
+    double maxCost = 0.0;
+    for (int edge = 0; edge < compact.edgeCount(); edge++) {
+        maxCost = fmax(maxCost, compact.edgeCost(edge));
+    }
+    double period = fmax(1.0, PERIOD_PER_EDGE_COST * maxCost);
+
+    TravelTimeProfiles profiles(graph, period);
+    Vector<TravelTimeProfiles::Breakpoint> rushHour;
+    rushHour.add({0.0, 1.0});
+    rushHour.add({0.3 * period, RUSH_HOUR_FACTOR});
+    rushHour.add({0.4 * period, 1.0});
+    int profile = profiles.addProfile(rushHour);
+    for (int edge = 0; edge < compact.edgeCount(); edge++) {
+        profiles.setProfile(compact.edgeAt(edge), profile);
+    }
+
+    SearchOptions options;
+    options.headless = true;
+    mt19937 random(seed);
+    uniform_real_distribution<double> pickDeparture(0.0, period);
+    int failures = 0;
+
+    for (size_t ii = 0; ii < queries.size(); ii++) {
+        const Query& query = queries[ii];
+        double departure = pickDeparture(random);
+        Path dijkstraPath = earliestArrivalDijkstra(graph, profiles, query.first, query.second, departure, options);
+        Path aStarPath = earliestArrivalAStar(graph, profiles, query.first, query.second, departure, options);
+        Path referencePath = dijkstrasAlgorithm(graph, query.first, query.second, options);
+
+        bool dijkstraValid, aStarValid;
+        pathCost(graph, dijkstraPath, query, dijkstraValid);
+        pathCost(graph, aStarPath, query, aStarValid);
+        bool found = !referencePath.isEmpty();
+        bool passed = dijkstraValid and aStarValid
+                      and dijkstraPath.isEmpty() != found and aStarPath.isEmpty() != found;
+
+        double arrival = 0.0, aStarArrival = 0.0, referenceArrival = 0.0;
+        if (passed and found) {
+            arrival = profiles.arrivalTime(dijkstraPath, departure);
+            aStarArrival = profiles.arrivalTime(aStarPath, departure);
+            referenceArrival = profiles.arrivalTime(referencePath, departure);
+            double tolerance = COST_TOLERANCE * fmax(1.0, arrival - departure);
+            passed = fabs(aStarArrival - arrival) <= tolerance and arrival <= referenceArrival + tolerance;
+        }
+        if (!passed) {
+            if (failures == 0) {
+                cerr << "earliest arrival: query " << ii << " from " << query.first->nodeName()
+                     << " to " << query.second->nodeName() << " departing at " << departure
+                     << " arrives at " << arrival << " (A*: " << aStarArrival
+                     << ", ordinary shortest path: " << referenceArrival << ")" << endl;
+            }
+            failures++;
+        }
+    }
+
+    if (!csv) {
+        cout << "  earliest arrival: " << queries.size() << " queries checked"
+             << (failures == 0 ? "" : ", " + to_string(failures) + " FAILED") << endl;
+    }
+    return failures;
+}
+
+/*
+ * Prints the usage message.
+ */
+void usage(const string& program) {
+    cerr << "Usage: " << program << " [-queries N] [-seed S] [-pairs file] [-warmup N] [-cache] [-profiles] [-csv] world-file"
+         << endl;
+}
+
+int main(int argc, char** argv) {
+
+    int numQueries = DEFAULT_NUM_QUERIES;
+    unsigned seed = DEFAULT_SEED;
+    int numWarmup = 0;
+    string pairsFile;
+    bool useCache = false;
+    bool useProfiles = false;
+    bool csv = false;
+    string worldFile;
+
+    for (int ii = 1; ii < argc; ii++) {
+        string arg = argv[ii];
+        if (arg == "-queries" and ii + 1 < argc) {
+            numQueries = atoi(argv[++ii]);
+        }
+        else if (arg == "-seed" and ii + 1 < argc) {
+            seed = strtoul(argv[++ii], nullptr, 10);
+        }
+        else if (arg == "-pairs" and ii + 1 < argc) {
+            pairsFile = argv[++ii];
+        }
+        else if (arg == "-warmup" and ii + 1 < argc) {
+            numWarmup = atoi(argv[++ii]);
+        }
+        else if (arg == "-cache") {
+            useCache = true;
+        }
+        else if (arg == "-profiles") {
+            useProfiles = true;
+        }
+        else if (arg == "-csv") {
+            csv = true;
+        }
+        else if (worldFile.empty() and arg[0] != '-') {
+            worldFile = arg;
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (worldFile.empty() or numQueries <= 0 or numWarmup < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    WorldFileHeader header;
+    Graph<RoadNode, RoadEdge> data;
+    bool loaded = useCache ? readWorldFileCached(worldFile, worldFile + ".cache", header, data)
+                           : readWorldFile(worldFile, header, data);
+    if (!loaded) {
+        cerr << worldFile << " is not a valid world file." << endl;
+        return 1;
+    }
+
+    RoadGraph graph(&data);
+    const CompactRoadGraph& compact = graph.compact();
+    if (compact.nodeCount() == 0) {
+        cerr << worldFile << " has no nodes." << endl;
+        return 1;
+    }
+
+    vector<Query> queries;
+    if (!pairsFile.empty()) {
+        if (!readQueries(pairsFile, data, queries)) {
+            return 1;
+        }
+        if (queries.empty()) {
+            cerr << pairsFile << " contains no queries." << endl;
+            return 1;
+        }
+    }
+    else {
+        randomQueries(compact, numQueries, seed, queries);
+    }
+
+    if (csv) {
+        cout << "algorithm,numQueries,meanUs,p50Us,p90Us,p99Us,maxUs,queriesPerSecond,failures,"
+             << SearchCounters::csvHeader() << endl;
+    }
+    else {
+        cout << worldFile << ": " << compact.nodeCount() << " nodes, " << compact.edgeCount() << " edges, "
+             << queries.size() << " queries" << endl;
+        cout << "  " << setw(12) << left << "algorithm" << right
+             << setw(10) << "mean us" << setw(10) << "p50 us" << setw(10) << "p90 us"
+             << setw(10) << "p99 us" << setw(10) << "max us" << setw(12) << "queries/s"
+             << setw(11) << "settled/q" << setw(11) << "relaxed/q" << endl;
+    }
+
+    vector<double> referenceCosts;
+    vector<double> costs;
+    int failures = 0;
+    for (const Algorithm& algorithm : ALGORITHMS) {
+        failures += benchmarkAlgorithm(algorithm, graph, queries, numWarmup, csv, referenceCosts, costs);
+        if (algorithm.check == REFERENCE) {
+            referenceCosts = costs;
+        }
+    }
+
+    if (useProfiles) {
+        failures += checkEarliestArrival(graph, queries, seed, csv);
+    }
+
+    return failures == 0 ? 0 : CHECK_FAILED;
+}
@@ -0,0 +1,401 @@
+/*
+ * Generates large synthetic road networks, for testing how the searches scale beyond the
+ * hand-made maps.  Two kinds of network can be made:
+ *
+ *   -grid       a city-like grid of blocks, with jittered intersections.  Every fourth
+ *               street is a secondary road, every eighth a primary road and every 32nd a
+ *               motorway; some residential streets are missing or one-way.
+ *   -geometric  intersections scattered at random, each joined to its nearest neighbors
+ *               by local roads.  A sparse layer of hubs is joined the same way by primary
+ *               roads, and a sparser one of those by motorways.  A few small islands can
+ *               be left unconnected, as on real maps.
+ *
+ * Coordinates are in meters (one pixel per meter), with about 100 m between neighboring
+ * intersections, and edge costs are travel times in seconds at the speed of the road's
+ * class, over a road a little longer than the straight line.  The same seed always makes
+ * the same network.  The world is written in the text format, or with -binary in the
+ * binary format (see WorldFile.h), which loads far faster.
+ *
+ * Usage: worldgen [-grid | -geometric] [-nodes N] [-seed S] [-image file] [-binary] output-file
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "WorldFile.h"
+using namespace std;
+
+static const int DEFAULT_NUM_NODES = 1000000;
+static const unsigned DEFAULT_SEED = 106;
+
+/* The image file named in the header.  Only the graphical program needs it to exist. */
+static const string DEFAULT_IMAGE = "none";
+
+/* Average distance between neighboring intersections, and the border around the map, in meters. */
+static const int BLOCK_LENGTH = 100;
+static const int MARGIN = BLOCK_LENGTH;
+
+/* Roads are at least this much and at most this much longer than the straight line. */
+static const double MIN_DETOUR = 1.0;
+static const double MAX_DETOUR = 1.25;
+
+/* Share of the residential streets that are left out, and of those left that are one-way. */
+static const double MISSING_STREETS = 0.08;
+static const double ONE_WAY_STREETS = 0.05;
+
+/* Number of nearest neighbors each intersection or hub of a geometric network is joined to. */
+static const int NEAREST_NEIGHBORS = 3;
+
+/* In a geometric network, one in this many intersections is a hub, and one in this many hubs a motorway junction. */
+static const int HUB_SPACING = 64;
+static const int JUNCTION_SPACING = 8;
+
+/* Share of the local roads in a geometric network that are secondary roads rather than residential. */
+static const double SECONDARY_ROADS = 0.2;
+
+/*
+ * The classes of road, slowest first, with their speeds in km/h.
+ */
+enum RoadClass {
+    RESIDENTIAL,
+    SECONDARY,
+    PRIMARY,
+    MOTORWAY
+};
+
+static const double SPEEDS[] = {30.0, 50.0, 70.0, 110.0};
+
+/*
+ * Returns the time in seconds to drive between the two intersections on a road of the
+ * given class, rounded to hundredths to keep the text format short.
+ */
+double travelTime(const WorldNode& a, const WorldNode& b, RoadClass roadClass, mt19937& random) {
+    uniform_real_distribution<double> detour(MIN_DETOUR, MAX_DETOUR);
+    double length = hypot(double(a.x - b.x), double(a.y - b.y)) * detour(random);
+    double seconds = length / (SPEEDS[roadClass] / 3.6);
+    return max(0.01, round(seconds * 100.0) / 100.0);
+}
+
+/*
+ * Adds a road between the two intersections: one edge if it is one-way (in a random
+ * direction), and otherwise an edge each way, next to each other so that the text format
+ * writes them as one undirected road.
+ */
+void addRoad(WorldData& world, int a, int b, RoadClass roadClass, bool oneWay, mt19937& random) {
+    double cost = travelTime(world.nodes[a], world.nodes[b], roadClass, random);
+    if (oneWay and random() % 2 == 0) {
+        swap(a, b);
+    }
+    world.edges.push_back({a, b, cost});
+    if (!oneWay) {
+        world.edges.push_back({b, a, cost});
+    }
+}
+
+/*
+ * Returns the class of the street along the given row or column of a grid network.
+ */
+RoadClass gridStreetClass(int line) {
+    if (line % 32 == 0) {
+        return MOTORWAY;
+    }
+    if (line % 8 == 0) {
+        return PRIMARY;
+    }
+    if (line % 4 == 0) {
+        return SECONDARY;
+    }
+    return RESIDENTIAL;
+}
+
+/*
+ * Adds the street between two neighboring intersections of a grid network, leaving out
+ * some residential streets and making others one-way.
+ */
+void addGridStreet(WorldData& world, int a, int b, RoadClass roadClass, mt19937& random) {
+    uniform_real_distribution<double> chance(0.0, 1.0);
+    if (roadClass == RESIDENTIAL and chance(random) < MISSING_STREETS) {
+        return;
+    }
+    bool oneWay = roadClass == RESIDENTIAL and chance(random) < ONE_WAY_STREETS;
+    addRoad(world, a, b, roadClass, oneWay, random);
+}
+
+/*
+ * Generates a grid network of the given number of intersections, filling the rows of a
+ * square grid in order (so the last row may be partly empty).
+ */
+void generateGrid(WorldData& world, int numNodes, mt19937& random) {
+
+    int columns = (int) ceil(sqrt(double(numNodes)));
+    uniform_int_distribution<int> jitter(-BLOCK_LENGTH / 4, BLOCK_LENGTH / 4);
+
+    world.nodes.reserve(numNodes);
+    for (int ii = 0; ii < numNodes; ii++) {
+        int row = ii / columns;
+        int column = ii % columns;
+        int x = MARGIN + column * BLOCK_LENGTH + jitter(random);
+        int y = MARGIN + row * BLOCK_LENGTH + jitter(random);
+        world.nodes.push_back({"n" + to_string(ii), x, y});
+    }
+
+    world.edges.reserve(4 * size_t(numNodes));
+    for (int ii = 0; ii < numNodes; ii++) {
+        int row = ii / columns;
+        int column = ii % columns;
+        if (column + 1 < columns and ii + 1 < numNodes) {
+            addGridStreet(world, ii, ii + 1, gridStreetClass(row), random);
+        }
+        if (ii + columns < numNodes) {
+            addGridStreet(world, ii, ii + columns, gridStreetClass(column), random);
+        }
+    }
+
+    int rows = (numNodes + columns - 1) / columns;
+    world.header.width = 2 * MARGIN + (columns - 1) * BLOCK_LENGTH;
+    world.header.height = 2 * MARGIN + (rows - 1) * BLOCK_LENGTH;
+}
+
+/*
+ * Adds to pairs, for every intersection in the subset, the pairs it forms with its k
+ * nearest other intersections in the subset.  The intersections are bucketed into a
+ * uniform grid of about one per cell, and each one searches rings of cells outward until
+ * no unsearched cell can hold anything nearer than the k nearest found so far.
+ */
+void nearestNeighbors(const WorldData& world, const vector<int>& subset, int k, vector<pair<int, int>>& pairs) {
+
+    if (subset.size() < 2) {
+        return;
+    }
+
+    int minX = world.nodes[subset[0]].x, maxX = minX;
+    int minY = world.nodes[subset[0]].y, maxY = minY;
+    for (int node : subset) {
+        minX = min(minX, world.nodes[node].x);
+        maxX = max(maxX, world.nodes[node].x);
+        minY = min(minY, world.nodes[node].y);
+        maxY = max(maxY, world.nodes[node].y);
+    }
+
+    int cellsPerSide = max(1, (int) sqrt(double(subset.size())));
+    double cellSize = max(1.0, double(max(maxX - minX, maxY - minY) + 1) / cellsPerSide);
+    auto cellOf = [&](int coordinate, int minCoordinate) {
+        return min(cellsPerSide - 1, int((coordinate - minCoordinate) / cellSize));
+    };
+
+    // Counting sort of the subset by cell
+    vector<int> cellStart(size_t(cellsPerSide) * cellsPerSide + 1, 0);
+    for (int node : subset) {
+        int cell = cellOf(world.nodes[node].y, minY) * cellsPerSide + cellOf(world.nodes[node].x, minX);
+        cellStart[cell + 1]++;
+    }
+    for (size_t cell = 1; cell < cellStart.size(); cell++) {
+        cellStart[cell] += cellStart[cell - 1];
+    }
+    vector<int> cellNodes(subset.size());
+    vector<int> nextSlot(cellStart.begin(), cellStart.end() - 1);
+    for (int node : subset) {
+        int cell = cellOf(world.nodes[node].y, minY) * cellsPerSide + cellOf(world.nodes[node].x, minX);
+        cellNodes[nextSlot[cell]++] = node;
+    }
+
+    vector<pair<double, int>> nearest;   // (squared distance, node), the k nearest so far
+    for (int node : subset) {
+        const WorldNode& here = world.nodes[node];
+        int cellX = cellOf(here.x, minX);
+        int cellY = cellOf(here.y, minY);
+        nearest.clear();
+
+        for (int ring = 0; ring < cellsPerSide; ring++) {
+            // The node can sit anywhere in its own cell, so anything in this ring or beyond
+            // is at least ring - 1 whole cells away
+            double reach = max(0, ring - 1) * cellSize;
+            if ((int) nearest.size() == k and nearest.back().first <= reach * reach) {
+                break;
+            }
+
+            for (int y = max(0, cellY - ring); y <= min(cellsPerSide - 1, cellY + ring); y++) {
+                for (int x = max(0, cellX - ring); x <= min(cellsPerSide - 1, cellX + ring); x++) {
+                    if (max(abs(x - cellX), abs(y - cellY)) != ring) {
+                        continue;
+                    }
+                    int cell = y * cellsPerSide + x;
+                    for (int slot = cellStart[cell]; slot < cellStart[cell + 1]; slot++) {
+                        int other = cellNodes[slot];
+                        if (other == node) {
+                            continue;
+                        }
+                        double dx = world.nodes[other].x - here.x;
+                        double dy = world.nodes[other].y - here.y;
+                        pair<double, int> candidate(dx * dx + dy * dy, other);
+                        if ((int) nearest.size() < k or candidate < nearest.back()) {
+                            if ((int) nearest.size() == k) {
+                                nearest.pop_back();
+                            }
+                            nearest.insert(upper_bound(nearest.begin(), nearest.end(), candidate), candidate);
+                        }
+                    }
+                }
+            }
+        }
+
+        for (const pair<double, int>& neighbor : nearest) {
+            pairs.push_back({node, neighbor.second});
+        }
+    }
+}
+
+/*
+ * Adds a road for each pair of intersections that is not joined yet, all of the given
+ * class (local roads are a mix of residential and secondary ones).
+ */
+void addRoads(WorldData& world, const vector<pair<int, int>>& pairs, RoadClass roadClass,
+              unordered_set<long long>& joined, mt19937& random) {
+
+    uniform_real_distribution<double> chance(0.0, 1.0);
+    for (const pair<int, int>& road : pairs) {
+        long long key = (long long) min(road.first, road.second) * world.nodes.size() + max(road.first, road.second);
+        if (!joined.insert(key).second) {
+            continue;
+        }
+
+        RoadClass thisClass = roadClass;
+        if (roadClass == RESIDENTIAL and chance(random) < SECONDARY_ROADS) {
+            thisClass = SECONDARY;
+        }
+        bool oneWay = thisClass == RESIDENTIAL and chance(random) < ONE_WAY_STREETS;
+        addRoad(world, road.first, road.second, thisClass, oneWay, random);
+    }
+}
+
+/*
+ * Generates a random geometric network of the given number of intersections, spread
+ * evenly over a square with the same density as a grid network.  Motorways are added
+ * first, then primary roads and then local roads, so a pair of intersections joined by
+ * more than one layer gets the fastest road.
+ */
+void generateGeometric(WorldData& world, int numNodes, mt19937& random) {
+
+    int extent = (int) ceil(sqrt(double(numNodes))) * BLOCK_LENGTH;
+    uniform_int_distribution<int> coordinate(MARGIN, MARGIN + extent);
+
+    world.nodes.reserve(numNodes);
+    for (int ii = 0; ii < numNodes; ii++) {
+        int x = coordinate(random);
+        int y = coordinate(random);
+        world.nodes.push_back({"n" + to_string(ii), x, y});
+    }
+
+    // The node order is already random, so every HUB_SPACING-th node is a random sample
+    vector<int> everyNode, hubs, junctions;
+    for (int ii = 0; ii < numNodes; ii++) {
+        everyNode.push_back(ii);
+        if (ii % HUB_SPACING == 0) {
+            hubs.push_back(ii);
+            if (ii % (HUB_SPACING * JUNCTION_SPACING) == 0) {
+                junctions.push_back(ii);
+            }
+        }
+    }
+
+    unordered_set<long long> joined;
+    world.edges.reserve(2 * NEAREST_NEIGHBORS * size_t(numNodes));
+    vector<pair<int, int>> pairs;
+
+    nearestNeighbors(world, junctions, NEAREST_NEIGHBORS, pairs);
+    addRoads(world, pairs, MOTORWAY, joined, random);
+    pairs.clear();
+    nearestNeighbors(world, hubs, NEAREST_NEIGHBORS, pairs);
+    addRoads(world, pairs, PRIMARY, joined, random);
+    pairs.clear();
+    nearestNeighbors(world, everyNode, NEAREST_NEIGHBORS, pairs);
+    addRoads(world, pairs, RESIDENTIAL, joined, random);
+
+    world.header.width = 2 * MARGIN + extent;
+    world.header.height = 2 * MARGIN + extent;
+}
+
+/*
+ * Prints the usage message.
+ */
+void usage(const string& program) {
+    cerr << "Usage: " << program
+         << " [-grid | -geometric] [-nodes N] [-seed S] [-image file] [-binary] output-file" << endl;
+}
+
+int main(int argc, char** argv) {
+
+    bool geometric = false;
+    int numNodes = DEFAULT_NUM_NODES;
+    unsigned seed = DEFAULT_SEED;
+    string imageFile = DEFAULT_IMAGE;
+    bool binary = false;
+    string outputFile;
+
+    for (int ii = 1; ii < argc; ii++) {
+        string arg = argv[ii];
+        if (arg == "-grid") {
+            geometric = false;
+        }
+        else if (arg == "-geometric") {
+            geometric = true;
+        }
+        else if (arg == "-nodes" and ii + 1 < argc) {
+            numNodes = atoi(argv[++ii]);
+        }
+        else if (arg == "-seed" and ii + 1 < argc) {
+            seed = strtoul(argv[++ii], nullptr, 10);
+        }
+        else if (arg == "-image" and ii + 1 < argc) {
+            imageFile = argv[++ii];
+        }
+        else if (arg == "-binary") {
+            binary = true;
+        }
+        else if (outputFile.empty() and arg[0] != '-') {
+            outputFile = arg;
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (outputFile.empty() or numNodes <= 0 or imageFile.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    WorldData world;
+    world.header.largeMapDisplay = true;
+    world.header.imageFile = imageFile;
+    mt19937 random(seed);
+
+    auto startTime = chrono::steady_clock::now();
+    if (geometric) {
+        generateGeometric(world, numNodes, random);
+    }
+    else {
+        generateGrid(world, numNodes, random);
+    }
+    auto generatedTime = chrono::steady_clock::now();
+
+    bool written = binary ? writeBinaryWorldFile(outputFile, world) : writeWorldFile(outputFile, world);
+    if (!written) {
+        cerr << "Cannot write " << outputFile << "." << endl;
+        return 1;
+    }
+    auto endTime = chrono::steady_clock::now();
+
+    cout << outputFile << ": " << world.nodes.size() << " nodes, " << world.edges.size() << " edges ("
+         << (geometric ? "geometric" : "grid") << " network, seed " << seed << ")" << endl;
+    cout << "Generation time: " << chrono::duration<double, milli>(generatedTime - startTime).count() << " ms" << endl;
+    cout << "Write time: " << chrono::duration<double, milli>(endTime - generatedTime).count() << " ms" << endl;
+    return 0;
+}